@@ -36,3 +36,17 @@ macro(configure_remus_test)
     add_test(NAME ${ARGV0} COMMAND ${ARGV0} WORKING_DIRECTORY ${CMAKE_SOURCE_DIR})
     add_dependencies(remus__tests ${ARGV0})
 endmacro(configure_remus_test)
+
+add_custom_target(remus__benchmarks)
+
+macro(configure_remus_benchmark)
+    message(STATUS "Benchmark ${ARGV0}")
+    set_target_properties(${ARGV0} PROPERTIES
+        LIBRARY_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/lib"
+        ARCHIVE_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/lib"
+        RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/bin/benchmark"
+        CXX_CLANG_TIDY "${CLANG_TIDY_COMMAND}"
+    )
+    target_link_libraries(${ARGV0} PRIVATE Catch2::Catch2WithMain)
+    add_dependencies(remus__benchmarks ${ARGV0})
+endmacro(configure_remus_benchmark)
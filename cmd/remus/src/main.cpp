@@ -1,17 +1,49 @@
 #include <common/logging.hpp>
+#include <events/channel.hpp>
+#include <loaders/models/gltf_loader.hpp>
+#include <scene_graph/scene_graph.hpp>
 
 #include <platforms/desktop_platform.hpp>
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
 	remus::DesktopPlatform platform;
 
 	auto window = platform.create_window("Remus", {800, 600});
 
+	auto thread_pool = std::make_shared<remus::ThreadPool>();
+
+	remus::SceneGraph scene_graph;
+	scene_graph.set_thread_pool(thread_pool);
+
+	// a model given on the command line loads in the background while the window keeps updating
+	remus::Channel<remus::GltfLoadEvent> load_events;
+	auto                                 load_progress = load_events.receiver({remus::ReceiverMode::Latest});
+
+	remus::GLtfLoader gltf_loader;
+	gltf_loader.set_thread_pool(thread_pool);
+
+	remus::GltfLoad load;
+	if (argc > 1)
+	{
+		load = gltf_loader.load_async(argv[1], load_events.sender());
+	}
+
 	while (true)
 	{
 		window->update();
 
+		// a few milliseconds of each frame go to adding the loaded model to the scene
+		load.commit(scene_graph, std::chrono::milliseconds(4));
+
+		remus::GltfLoadEvent event;
+		if (load_progress->next(&event))
+		{
+			LOGI("Loading {}: {} {}/{}", event.path, remus::to_string(event.stage), event.completed, event.total);
+		}
+
+		scene_graph.update(0.016f);
+
 		std::this_thread::sleep_for(std::chrono::milliseconds(16));
 	}
 
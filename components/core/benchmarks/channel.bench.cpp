@@ -0,0 +1,409 @@
+#include <events/channel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+struct Mode
+{
+	const char          *name;
+	remus::ReceiverMode mode;
+};
+
+const Mode modes[] = {
+    {"deque", remus::ReceiverMode::Unbounded},
+    {"SPSC ring", remus::ReceiverMode::SPSC},
+    {"MPSC ring", remus::ReceiverMode::MPSC},
+};
+
+remus::ReceiverOptions blocking(remus::ReceiverMode mode)
+{
+	remus::ReceiverOptions options;
+	options.mode     = mode;
+	options.capacity = 4096;
+	options.overflow = remus::OverflowPolicy::Block;
+	return options;
+}
+
+// send event_count events from each producer while the calling thread consumes them
+void stream(remus::Channel<size_t> &channel, remus::Receiver<size_t> *receiver, size_t producer_count, size_t event_count)
+{
+	std::vector<remus::Sender<size_t> *> senders;
+	for (size_t p = 0; p < producer_count; ++p)
+	{
+		senders.push_back(channel.sender());
+	}
+
+	std::vector<std::thread> producers;
+	for (auto *sender : senders)
+	{
+		producers.emplace_back([sender, event_count]() {
+			for (size_t i = 0; i < event_count; ++i)
+			{
+				sender->send(i);
+			}
+		});
+	}
+
+	size_t received = 0;
+	size_t event;
+	while (received < producer_count * event_count)
+	{
+		if (receiver->next(&event))
+		{
+			received++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+}
+}        // namespace
+
+TEST_CASE("Channel throughput", "[core][benchmark]")
+{
+	constexpr size_t event_count = 100000;
+
+	for (auto &mode : modes)
+	{
+		for (size_t producer_count : {1, 4})
+		{
+			// a single producer ring can not take several producers
+			if (mode.mode == remus::ReceiverMode::SPSC && producer_count > 1)
+			{
+				continue;
+			}
+
+			auto name = std::string(mode.name) + ", " + std::to_string(producer_count) + " producer(s), 100k events each";
+			BENCHMARK(std::move(name))
+			{
+				remus::Channel<size_t> channel;
+				auto                   receiver = channel.receiver(blocking(mode.mode));
+				stream(channel, receiver.get(), producer_count, event_count);
+				return receiver->dropped();
+			};
+		}
+	}
+}
+
+TEST_CASE("Channel round trip latency", "[core][benchmark]")
+{
+	constexpr size_t round_trips = 10000;
+
+	for (auto &mode : modes)
+	{
+		auto name = std::string(mode.name) + ", 10k round trips";
+		BENCHMARK(std::move(name))
+		{
+			remus::Channel<size_t> ping;
+			remus::Channel<size_t> pong;
+
+			auto  ping_receiver = ping.receiver(blocking(mode.mode));
+			auto  pong_receiver = pong.receiver(blocking(mode.mode));
+			auto *ping_sender   = ping.sender();
+			auto *pong_sender   = pong.sender();
+
+			// echo every ping back
+			std::thread echo([&]() {
+				size_t event;
+				for (size_t i = 0; i < round_trips;)
+				{
+					if (ping_receiver->next(&event))
+					{
+						pong_sender->send(event);
+						i++;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+
+			size_t event = 0;
+			for (size_t i = 0; i < round_trips; ++i)
+			{
+				ping_sender->send(i);
+				while (!pong_receiver->next(&event))
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			echo.join();
+			return event;
+		};
+	}
+}
+
+TEST_CASE("Channel batches", "[core][benchmark]")
+{
+	constexpr size_t event_count = 100000;
+	constexpr size_t batch_size  = 256;
+
+	std::vector<size_t> events(event_count);
+	for (size_t i = 0; i < event_count; ++i)
+	{
+		events[i] = i;
+	}
+
+	for (auto &mode : modes)
+	{
+		BENCHMARK(std::string(mode.name) + ", 100k events one at a time")
+		{
+			remus::Channel<size_t> channel;
+			auto                   receiver = channel.receiver(blocking(mode.mode));
+			auto                  *sender   = channel.sender();
+
+			size_t sum = 0;
+			size_t event;
+			for (size_t first = 0; first < event_count; first += batch_size)
+			{
+				auto last = std::min(first + batch_size, event_count);
+				for (size_t i = first; i < last; ++i)
+				{
+					sender->send(events[i]);
+				}
+				while (receiver->next(&event))
+				{
+					sum += event;
+				}
+			}
+			return sum;
+		};
+
+		BENCHMARK(std::string(mode.name) + ", 100k events in batches of 256")
+		{
+			remus::Channel<size_t> channel;
+			auto                   receiver = channel.receiver(blocking(mode.mode));
+			auto                  *sender   = channel.sender();
+
+			size_t              sum = 0;
+			std::vector<size_t> received;
+			received.reserve(batch_size);
+			for (size_t first = 0; first < event_count; first += batch_size)
+			{
+				sender->send_batch(events.data() + first, std::min(batch_size, event_count - first));
+
+				received.clear();
+				receiver->drain_into(received);
+				for (auto event : received)
+				{
+					sum += event;
+				}
+			}
+			return sum;
+		};
+	}
+}
+
+TEST_CASE("Channel fan out of large events", "[core][benchmark]")
+{
+	constexpr size_t event_count    = 1000;
+	constexpr size_t receiver_count = 8;
+
+	using Payload = std::vector<uint8_t>;
+
+	// build a fresh 1KB payload per event, as a producer would
+	auto make_payload = [](size_t i) { return Payload(1024, static_cast<uint8_t>(i)); };
+
+	BENCHMARK("1KB events, 8 receivers, copied into every receiver")
+	{
+		remus::Channel<Payload> channel;
+
+		std::vector<remus::ReceiverHandle<Payload>> receivers;
+		for (size_t i = 0; i < receiver_count; ++i)
+		{
+			receivers.push_back(channel.receiver());
+		}
+		auto *sender = channel.sender();
+
+		for (size_t i = 0; i < event_count; ++i)
+		{
+			const auto payload = make_payload(i);
+			sender->send(payload);
+		}
+		return receivers.back()->drain(nullptr);
+	};
+
+	BENCHMARK("1KB events, 8 receivers, moved into the last receiver")
+	{
+		remus::Channel<Payload> channel;
+
+		std::vector<remus::ReceiverHandle<Payload>> receivers;
+		for (size_t i = 0; i < receiver_count; ++i)
+		{
+			receivers.push_back(channel.receiver());
+		}
+		auto *sender = channel.sender();
+
+		for (size_t i = 0; i < event_count; ++i)
+		{
+			sender->send(make_payload(i));
+		}
+		return receivers.back()->drain(nullptr);
+	};
+
+	BENCHMARK("1KB events, 8 receivers, shared payload")
+	{
+		remus::Channel<remus::SharedEvent<Payload>> channel;
+
+		std::vector<remus::ReceiverHandle<remus::SharedEvent<Payload>>> receivers;
+		for (size_t i = 0; i < receiver_count; ++i)
+		{
+			receivers.push_back(channel.receiver());
+		}
+		auto *sender = channel.sender();
+
+		for (size_t i = 0; i < event_count; ++i)
+		{
+			sender->send(std::make_shared<const Payload>(make_payload(i)));
+		}
+		return receivers.back()->drain(nullptr);
+	};
+}
+
+TEST_CASE("Channel wake up latency", "[core][benchmark]")
+{
+	using namespace std::chrono_literals;
+
+	constexpr size_t round_trips = 200;
+
+	// wait for the next event with each strategy a consumer thread might use
+	auto wait_next = [](remus::Receiver<size_t> *receiver, size_t *event) { receiver->wait_next(event, 1s); };
+	auto yield     = [](remus::Receiver<size_t> *receiver, size_t *event) {
+		while (!receiver->next(event))
+		{
+			std::this_thread::yield();
+		}
+	};
+	auto sleep = [](remus::Receiver<size_t> *receiver, size_t *event) {
+		while (!receiver->next(event))
+		{
+			std::this_thread::sleep_for(100us);
+		}
+	};
+
+	auto ping_pong = [&](auto &&wait) {
+		remus::Channel<size_t> ping;
+		remus::Channel<size_t> pong;
+
+		auto  ping_receiver = ping.receiver();
+		auto  pong_receiver = pong.receiver();
+		auto *ping_sender   = ping.sender();
+		auto *pong_sender   = pong.sender();
+
+		std::thread echo([&]() {
+			size_t event;
+			for (size_t i = 0; i < round_trips; ++i)
+			{
+				wait(ping_receiver.get(), &event);
+				pong_sender->send(event);
+			}
+		});
+
+		size_t event = 0;
+		for (size_t i = 0; i < round_trips; ++i)
+		{
+			ping_sender->send(i);
+			wait(pong_receiver.get(), &event);
+		}
+
+		echo.join();
+		return event;
+	};
+
+	BENCHMARK("200 round trips, wait_next")
+	{
+		return ping_pong(wait_next);
+	};
+
+	BENCHMARK("200 round trips, polling with yield")
+	{
+		return ping_pong(yield);
+	};
+
+	BENCHMARK("200 round trips, polling with a 100us sleep")
+	{
+		return ping_pong(sleep);
+	};
+}
+
+namespace
+{
+struct State
+{
+	size_t key;
+	size_t frame;
+	float  values[14];
+};
+
+// one producer sends event_count states while the calling thread keeps reading the latest until it sees the last one
+template <typename Read>
+size_t follow(remus::Channel<State> &channel, size_t event_count, Read &&read)
+{
+	auto        sender = channel.sender();
+	std::thread producer([sender, event_count]() {
+		for (size_t i = 0; i < event_count; ++i)
+		{
+			sender->send(State{i % 16, i, {}});
+		}
+	});
+
+	size_t reads = 0;
+	State  state{};
+	while (state.frame + 1 < event_count)
+	{
+		if (read(&state))
+		{
+			reads++;
+		}
+	}
+	producer.join();
+	return reads;
+}
+}        // namespace
+
+TEST_CASE("Channel latest state", "[core][benchmark]")
+{
+	constexpr size_t event_count = 100000;
+
+	BENCHMARK("64B states, 100k sent, deque drained for the last")
+	{
+		remus::Channel<State> channel;
+		auto                  receiver = channel.receiver();
+		return follow(channel, event_count, [&](State *state) { return receiver->drain(state); });
+	};
+
+	BENCHMARK("64B states, 100k sent, latest only")
+	{
+		remus::Channel<State>  channel;
+		remus::ReceiverOptions options;
+		options.mode  = remus::ReceiverMode::Latest;
+		auto receiver = channel.receiver(options);
+		return follow(channel, event_count, [&](State *state) { return receiver->next(state); });
+	};
+
+	BENCHMARK("64B states, 100k sent, coalesced over 16 keys")
+	{
+		remus::Channel<State> channel;
+		auto                  receiver = channel.coalescing_receiver([](const State &state) { return state.key; });
+		return follow(channel, event_count, [&](State *state) { return receiver->next(state); });
+	};
+}
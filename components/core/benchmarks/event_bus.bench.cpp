@@ -0,0 +1,266 @@
+#include <events/event_bus.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+struct Event
+{
+	int value;
+};
+
+class Handler : public remus::EventHandler<Event>
+{
+  public:
+	void handle(Event event) override
+	{
+		sum += event.value;
+	}
+
+	int sum = 0;
+};
+
+// the bus before dispatch tables, hashed by type and handler with a std::function per handler
+class MapEventBus
+{
+  public:
+	template <typename T>
+	void bind(remus::TypedEventHandler<T> *handler)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		handlers[std::type_index(typeid(T))][handler] = [handler](void *event) {
+			handler->handle(*static_cast<T *>(event));
+		};
+	}
+
+	template <typename T>
+	void unbind(remus::TypedEventHandler<T> *handler)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		handlers[std::type_index(typeid(T))].erase(handler);
+	}
+
+	template <typename T>
+	void publish(T event)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = handlers.find(std::type_index(typeid(T)));
+		if (it == handlers.end())
+		{
+			return;
+		}
+		for (auto &handler : it->second)
+		{
+			handler.second(&event);
+		}
+	}
+
+  private:
+	std::mutex mutex;
+
+	std::unordered_map<std::type_index, std::unordered_map<remus::EventBusObserver *, std::function<void(void *)>>> handlers;
+};
+}        // namespace
+
+TEST_CASE("Publish through the event bus", "[core][benchmark]")
+{
+	constexpr int event_count = 100000;
+
+	for (size_t handler_count : {1, 8})
+	{
+		std::vector<std::unique_ptr<Handler>> handlers;
+
+		remus::EventBus event_bus;
+		MapEventBus     map_event_bus;
+		for (size_t i = 0; i < handler_count; ++i)
+		{
+			handlers.push_back(std::make_unique<Handler>());
+			event_bus.bind<Event>(handlers.back().get());
+			map_event_bus.bind<Event>(handlers.back().get());
+		}
+
+		auto suffix = ", 100k events, " + std::to_string(handler_count) + " handler(s)";
+
+		BENCHMARK("virtual calls" + suffix)
+		{
+			for (int i = 0; i < event_count; ++i)
+			{
+				for (auto &handler : handlers)
+				{
+					static_cast<remus::TypedEventHandler<Event> *>(handler.get())->handle(Event{i});
+				}
+			}
+			return handlers.back()->sum;
+		};
+
+		BENCHMARK("dispatch tables" + suffix)
+		{
+			for (int i = 0; i < event_count; ++i)
+			{
+				event_bus.publish(Event{i});
+			}
+			return handlers.back()->sum;
+		};
+
+		BENCHMARK("hash maps" + suffix)
+		{
+			for (int i = 0; i < event_count; ++i)
+			{
+				map_event_bus.publish(Event{i});
+			}
+			return handlers.back()->sum;
+		};
+	}
+}
+
+namespace
+{
+template <int N>
+struct Typed
+{
+	int value;
+};
+
+class TypedHandler : public remus::EventHandler<Typed<0>, Typed<1>, Typed<2>, Typed<3>>
+{
+  public:
+	void handle(Typed<0> event) override
+	{
+		sums[0] += event.value;
+	}
+	void handle(Typed<1> event) override
+	{
+		sums[1] += event.value;
+	}
+	void handle(Typed<2> event) override
+	{
+		sums[2] += event.value;
+	}
+	void handle(Typed<3> event) override
+	{
+		sums[3] += event.value;
+	}
+
+	int sums[4]{};
+};
+
+// every producer sends event_count events of each of the four types
+template <typename Send>
+void produce(size_t producer_count, int event_count, Send &&send)
+{
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < producer_count; ++p)
+	{
+		producers.emplace_back([&]() {
+			for (int i = 0; i < event_count; ++i)
+			{
+				send(Typed<0>{i});
+				send(Typed<1>{i});
+				send(Typed<2>{i});
+				send(Typed<3>{i});
+			}
+		});
+	}
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+}
+}        // namespace
+
+TEST_CASE("Publish immediately or queue until a sync point", "[core][benchmark]")
+{
+	constexpr size_t producer_count = 4;
+	constexpr int    event_count    = 10000;
+
+	remus::EventBus   event_bus;
+	remus::ThreadPool thread_pool;
+
+	std::vector<std::unique_ptr<TypedHandler>> handlers;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		handlers.push_back(std::make_unique<TypedHandler>());
+		event_bus.enable(*handlers.back());
+	}
+
+	BENCHMARK("4 producers, 4 types, published immediately")
+	{
+		produce(producer_count, event_count, [&](auto event) { event_bus.publish(event); });
+		return handlers.back()->sums[0];
+	};
+
+	BENCHMARK("4 producers, 4 types, queued then dispatched")
+	{
+		produce(producer_count, event_count, [&](auto event) { event_bus.enqueue(event); });
+		event_bus.dispatch_queued();
+		return handlers.back()->sums[0];
+	};
+
+	BENCHMARK("4 producers, 4 types, queued then dispatched on the thread pool")
+	{
+		produce(producer_count, event_count, [&](auto event) { event_bus.enqueue(event); });
+		event_bus.dispatch_queued(&thread_pool);
+		return handlers.back()->sums[0];
+	};
+}
+
+TEST_CASE("Publish while handlers are bound and unbound", "[core][benchmark]")
+{
+	constexpr int event_count = 100000;
+
+	Handler handler;
+
+	// a second thread keeps registering and unregistering a handler until the publisher is done
+	auto churn = [](auto &&publish, auto &&bind, auto &&unbind) {
+		std::atomic<bool> done{false};
+		std::thread       registrar([&]() {
+			Handler transient;
+			while (!done.load(std::memory_order_relaxed))
+			{
+				bind(&transient);
+				unbind(&transient);
+			}
+		});
+
+		for (int i = 0; i < event_count; ++i)
+		{
+			publish(Event{i});
+		}
+		done = true;
+		registrar.join();
+	};
+
+	BENCHMARK("100k events while binding and unbinding, dispatch tables")
+	{
+		remus::EventBus event_bus;
+		event_bus.bind<Event>(&handler);
+		churn([&](Event event) { event_bus.publish(event); },
+		      [&](Handler *transient) { transient->enable(event_bus); },
+		      [&](Handler *transient) { transient->disable(); });
+		return handler.sum;
+	};
+
+	BENCHMARK("100k events while binding and unbinding, hash maps")
+	{
+		MapEventBus map_event_bus;
+		map_event_bus.bind<Event>(&handler);
+		churn([&](Event event) { map_event_bus.publish(event); },
+		      [&](Handler *transient) { map_event_bus.bind<Event>(transient); },
+		      [&](Handler *transient) { map_event_bus.unbind<Event>(transient); });
+		return handler.sum;
+	};
+}
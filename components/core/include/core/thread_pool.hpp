@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace remus
+{
+/* A fixed set of worker threads executing submitted tasks.
+ * Every worker owns a task queue, tasks submitted from a worker go to its own queue and idle workers steal from the others.
+ * parallel_for() splits a range into chunks which are processed by the workers and the calling thread.
+ */
+class ThreadPool
+{
+  public:
+	explicit ThreadPool(size_t worker_count = std::max(1u, std::thread::hardware_concurrency()) - 1);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &)            = delete;
+	ThreadPool(ThreadPool &&)                 = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	ThreadPool &operator=(ThreadPool &&)      = delete;
+
+	// number of worker threads, the thread calling parallel_for() also takes part
+	size_t size() const
+	{
+		return workers.size();
+	}
+
+	// run a task on one of the workers, the task must not throw
+	void submit(std::function<void()> task);
+
+	/*
+	 * Call func(begin, end) for consecutive chunks of [0, count) of at most grain_size elements.
+	 * Blocks until every chunk has been processed. If func throws the chunks not yet started are skipped
+	 * and the first exception is rethrown once no chunk is running any more.
+	 */
+	template <typename Func>
+	void parallel_for(size_t count, size_t grain_size, Func &&func);
+
+  private:
+	struct Queue
+	{
+		std::mutex                        mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::thread>            workers;
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	// tasks submitted but not yet taken, incremented under mutex before the task is pushed so that sleeping workers are not missed
+	std::atomic<size_t>     pending{0};
+	std::atomic<size_t>     next_queue{0};
+	std::mutex              mutex;
+	std::condition_variable condition;
+	bool                    stopping{false};
+
+	void run_worker(size_t index);
+
+	// pop from the back of the worker's own queue, otherwise steal from the front of another queue
+	bool take(size_t index, std::function<void()> &task);
+
+	// the queue of the calling thread if it is one of our workers
+	size_t current_queue();
+
+	static std::pair<const ThreadPool *, size_t> &current_worker()
+	{
+		thread_local std::pair<const ThreadPool *, size_t> worker{nullptr, 0};
+		return worker;
+	}
+};
+}        // namespace remus
+
+namespace remus
+{
+inline ThreadPool::ThreadPool(size_t worker_count)
+{
+	for (size_t i = 0; i < worker_count; ++i)
+	{
+		queues.push_back(std::make_unique<Queue>());
+	}
+
+	workers.reserve(worker_count);
+	for (size_t i = 0; i < worker_count; ++i)
+	{
+		workers.emplace_back([this, i]() { run_worker(i); });
+	}
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+inline void ThreadPool::submit(std::function<void()> task)
+{
+	if (workers.empty())
+	{
+		task();
+		return;
+	}
+
+	// counted before it is pushed, so a worker taking it straight away can not decrement pending below zero
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending++;
+	}
+
+	auto &queue = *queues[current_queue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	condition.notify_one();
+}
+
+inline size_t ThreadPool::current_queue()
+{
+	auto &worker = current_worker();
+	if (worker.first == this)
+	{
+		return worker.second;
+	}
+	return next_queue++ % queues.size();
+}
+
+inline bool ThreadPool::take(size_t index, std::function<void()> &task)
+{
+	{
+		auto &own = *queues[index];
+
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (size_t offset = 1; offset < queues.size(); ++offset)
+	{
+		auto &victim = *queues[(index + offset) % queues.size()];
+
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline void ThreadPool::run_worker(size_t index)
+{
+	current_worker() = {this, index};
+
+	while (true)
+	{
+		std::function<void()> task;
+		if (take(index, task))
+		{
+			pending--;
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this]() { return stopping || pending > 0; });
+
+		if (stopping && pending == 0)
+		{
+			return;
+		}
+	}
+}
+
+template <typename Func>
+void ThreadPool::parallel_for(size_t count, size_t grain_size, Func &&func)
+{
+	grain_size         = std::max<size_t>(grain_size, 1);
+	size_t chunk_count = (count + grain_size - 1) / grain_size;
+
+	if (chunk_count <= 1 || workers.empty())
+	{
+		if (count > 0)
+		{
+			func(size_t{0}, count);
+		}
+		return;
+	}
+
+	// shared with the helpers, a helper which starts after the last chunk was taken only touches this state
+	struct State
+	{
+		std::atomic<size_t>     next_chunk{0};
+		std::atomic<size_t>     completed_chunks{0};
+		std::atomic<bool>       failed{false};
+		std::exception_ptr      error;        // the first exception thrown, guarded by mutex
+		std::mutex              mutex;
+		std::condition_variable condition;
+	};
+
+	auto  state = std::make_shared<State>();
+	auto *body  = &func;
+
+	auto run_chunks = [state, body, count, grain_size, chunk_count]() {
+		size_t completed = 0;
+		for (size_t chunk = state->next_chunk++; chunk < chunk_count; chunk = state->next_chunk++)
+		{
+			// an exception must not leave a worker, nor unwind the caller while helpers still call func
+			if (!state->failed.load(std::memory_order_relaxed))
+			{
+				size_t begin = chunk * grain_size;
+				try
+				{
+					(*body)(begin, std::min(begin + grain_size, count));
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (!state->error)
+					{
+						state->error = std::current_exception();
+					}
+					state->failed = true;
+				}
+			}
+			completed++;
+		}
+
+		if (completed > 0 && state->completed_chunks.fetch_add(completed) + completed == chunk_count)
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->condition.notify_all();
+		}
+	};
+
+	size_t helper_count = std::min(workers.size(), chunk_count - 1);
+	for (size_t i = 0; i < helper_count; ++i)
+	{
+		submit(run_chunks);
+	}
+
+	run_chunks();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&]() { return state->completed_chunks.load() == chunk_count; });
+
+	if (state->error)
+	{
+		std::rethrow_exception(state->error);
+	}
+}
+}        // namespace remus
@@ -1,25 +1,77 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <mutex>
-#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
+#include "rcu_pointer.hpp"
+#include "ring_buffer.hpp"
+#include "tracing.hpp"
+#include "triple_buffer.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#	define REMUS_CHANNEL_COROUTINES
+#	include <coroutine>
+#	include <utility>
+
+#	include <core/thread_pool.hpp>
+#endif
+
 namespace remus
 {
+// how a receiver queues its events
+enum class ReceiverMode
+{
+	Unbounded,        // a deque behind a mutex
+	SPSC,             // a lock-free ring, events must be sent from one thread at a time
+	MPSC,             // a lock-free ring, events may be sent from any thread
+	Latest            // only the latest event is kept, receiving never waits on senders
+};
+
+// an immutable event shared by every receiver, fanning it out copies a pointer instead of the payload
+template <typename T>
+using SharedEvent = std::shared_ptr<const T>;
+
+struct ReceiverOptions
+{
+	ReceiverMode   mode{ReceiverMode::Unbounded};
+	size_t         capacity{1024};        // rounded up to a power of two, SPSC and MPSC only
+	OverflowPolicy overflow{OverflowPolicy::DropOldest};
+
+	// with REMUS_EVENT_TRACING the queue depth is plotted in Tracy under this name, it must outlive the receiver
+	const char *name{nullptr};
+};
+
 template <typename T>
 class Sender;
 
 template <typename T>
 class Receiver;
 
+template <typename T>
+class ReceiverHandle;
+
+/* Fans events out from any number of senders to every subscribed receiver.
+ * The receivers are an immutable list replaced whole on every subscription change (read-copy-update).
+ * Sending loads the current list through a plain atomic pointer and never waits on receivers being added or removed.
+ * A replaced list, and the receivers only it holds, is freed by the subscription change or the send which finds no send still using it.
+ */
 template <typename T>
 class Channel
 {
   public:
 	friend class Sender<T>;
 	friend class Receiver<T>;
+	friend class ReceiverHandle<T>;
 
 	Channel()  = default;
 	~Channel() = default;
@@ -29,15 +81,61 @@ class Channel
 	Channel &operator=(const Channel &) = delete;
 	Channel &operator=(Channel &&)      = delete;
 
-	Receiver<T> *receiver();
-	Sender<T>   *sender();
+	// subscribe a receiver, it is unsubscribed when the handle is destroyed
+	ReceiverHandle<T> receiver(const ReceiverOptions &options = {});
+
+	// subscribe a receiver keeping only the latest event of each key, an event replaces the queued one with the same key in place
+	// events are received in the order their key was first sent since it was last received
+	ReceiverHandle<T> coalescing_receiver(std::function<size_t(const T &)> key, const char *name = nullptr);
+
+	Sender<T> *sender();
+
+	// number of subscribed receivers
+	size_t receiver_count() const
+	{
+		Reader current(receivers);
+		return current->size();
+	}
+
+	// the stats of the subscribed receivers combined, empty unless built with REMUS_EVENT_TRACING
+	ChannelStats stats() const;
+
+	// wait until every send which started before the call is done and free the replaced receiver lists, the caller must not be sending
+	void synchronize();
 
   private:
+	using Receivers = std::vector<std::shared_ptr<Receiver<T>>>;
+
+	// registers a send as a reader of the current receiver list for its lifetime
+	using Reader = typename RcuPointer<Receivers>::Reader;
+
+	ReceiverHandle<T> subscribe(std::shared_ptr<Receiver<T>> receiver);
+	void              unsubscribe(const Receiver<T> *receiver);
+
 	void send(const T &event) const;
+	void send(T &&event) const;
+	void send_batch(const T *events, size_t count) const;
 
-	mutable std::shared_mutex                 mutex;
-	std::vector<std::unique_ptr<Receiver<T>>> receivers;
-	std::vector<std::unique_ptr<Sender<T>>>   senders;
+	template <typename... Args>
+	void emplace(Args &&...args) const;
+
+	// serialises subscription changes and sender creation, sending does not take it
+	std::mutex                              mutex;
+	mutable RcuPointer<Receivers>           receivers;        // sends are const but may free retired lists
+	std::vector<std::unique_ptr<Sender<T>>> senders;
+
+#if defined(REMUS_EVENT_TRACING)
+	mutable std::atomic<uint64_t> sent_count{0};
+#endif
+
+	void trace_sent(size_t count) const
+	{
+#if defined(REMUS_EVENT_TRACING)
+		sent_count.fetch_add(count, std::memory_order_relaxed);
+#else
+		(void) count;
+#endif
+	}
 };
 
 template <typename T>
@@ -48,12 +146,31 @@ class Sender
 
 	~Sender() = default;
 
-	// send an event
+	// send an event, copied into every receiver
 	void send(const T &event) const
 	{
 		channel->send(event);
 	}
 
+	// send an event, copied into every receiver but the last which takes it
+	void send(T &&event) const
+	{
+		channel->send(std::move(event));
+	}
+
+	// construct an event in place, with a single receiver it is built straight into its queue
+	template <typename... Args>
+	void emplace(Args &&...args) const
+	{
+		channel->emplace(std::forward<Args>(args)...);
+	}
+
+	// send count events, each receiver takes its lock once for the whole batch
+	void send_batch(const T *events, size_t count) const
+	{
+		channel->send_batch(events, count);
+	}
+
   private:
 	Sender(Channel<T> *channel) :
 	    channel(channel)
@@ -72,83 +189,730 @@ class Receiver
   public:
 	~Receiver() = default;
 
-	// receive the last event
+	// receive the oldest event
 	bool next(T *event)
 	{
+		if (lock_free())
+		{
+			return pop(event);
+		}
+
 		std::lock_guard<std::mutex> lock(mutex);
 		if (events.empty())
 		{
 			return false;
 		}
+		forget_keys(1);
 		if (event)
 		{
-			*event = events.front();
+			*event = std::move(events.front());
 		}
 		events.pop_front();
+		trace_dequeued(1);
 		return true;
 	}
 
+	// receive the oldest event, waiting up to timeout for one to be sent
+	template <typename Rep, typename Period>
+	bool wait_next(T *event, const std::chrono::duration<Rep, Period> &timeout)
+	{
+		if (next(event))
+		{
+			return true;
+		}
+
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		waiters.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		bool received = wake_up.wait_for(lock, timeout, [&]() { return next(event); });
+
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+		return received;
+	}
+
+#if defined(REMUS_CHANNEL_COROUTINES)
+	class NextAwaitable
+	{
+	  public:
+		bool await_ready()
+		{
+			received = receiver->next(event);
+			return received;
+		}
+
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			return receiver->suspend(handle, thread_pool);
+		}
+
+		// false if another consumer took the event first
+		bool await_resume()
+		{
+			return received || receiver->next(event);
+		}
+
+	  private:
+		friend class Receiver<T>;
+
+		NextAwaitable(Receiver<T> *receiver, T *event, ThreadPool *thread_pool) :
+		    receiver(receiver),
+		    event(event),
+		    thread_pool(thread_pool)
+		{}
+
+		Receiver<T> *receiver;
+		T           *event;
+		ThreadPool  *thread_pool;
+		bool         received{false};
+	};
+
+	/*
+	 * co_await receiver->next_async(&event) suspends the coroutine until an event is sent.
+	 * The coroutine is resumed on the thread pool, or on the sending thread when there is none.
+	 */
+	NextAwaitable next_async(T *event, ThreadPool *thread_pool = nullptr)
+	{
+		return NextAwaitable(this, event, thread_pool);
+	}
+#endif
+
 	// drain all events receive the last one
 	bool drain(T *event)
 	{
+		if (lock_free())
+		{
+			bool received = false;
+			while (pop(event))
+			{
+				received = true;
+			}
+			return received;
+		}
+
 		std::lock_guard<std::mutex> lock(mutex);
 		if (events.empty())
 		{
 			return false;
 		}
+		forget_keys(events.size());
 		if (event)
 		{
-			*event = events.back();
+			*event = std::move(events.back());
 		}
+		trace_dequeued(events.size());
 		events.clear();
 		return true;
 	}
 
+	// move up to max of the oldest events into out, returns the number received
+	size_t receive_batch(T *out, size_t max)
+	{
+		if (lock_free())
+		{
+			size_t count = 0;
+			while (count < max && pop(out + count))
+			{
+				count++;
+			}
+			return count;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto                        count = std::min(max, events.size());
+		forget_keys(count);
+		std::move(events.begin(), events.begin() + count, out);
+		events.erase(events.begin(), events.begin() + count);
+		trace_dequeued(count);
+		return count;
+	}
+
+	// move every event to the back of out, returns the number received
+	size_t drain_into(std::vector<T> &out)
+	{
+		auto first = out.size();
+		if (lock_free())
+		{
+			T event;
+			while (pop(&event))
+			{
+				out.push_back(std::move(event));
+			}
+			return out.size() - first;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		forget_keys(events.size());
+		out.insert(out.end(), std::make_move_iterator(events.begin()), std::make_move_iterator(events.end()));
+		trace_dequeued(events.size());
+		events.clear();
+		return out.size() - first;
+	}
+
+	// number of events discarded by the overflow policy of a bounded receiver, or replaced by a later one when coalescing
+	size_t dropped() const
+	{
+		return dropped_count.load(std::memory_order_relaxed);
+	}
+
+	// empty unless built with REMUS_EVENT_TRACING
+	ReceiverStats stats() const
+	{
+		ReceiverStats stats;
+		stats.dropped = dropped();
+#if defined(REMUS_EVENT_TRACING)
+		stats.high_water = high_water.load(std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(trace_mutex);
+		stats.received = received_count;
+		stats.latency  = latency;
+#endif
+		return stats;
+	}
+
   private:
-	Receiver() = default;
+	Receiver(const ReceiverOptions &options, std::function<size_t(const T &)> key = {}) :
+	    key(std::move(key)),
+	    overflow(options.overflow),
+	    name(options.name)
+	{
+		if (this->key)
+		{
+			return;
+		}
+		if (options.mode == ReceiverMode::Latest)
+		{
+			latest = std::make_unique<TripleBuffer<T>>();
+		}
+		else if (options.mode != ReceiverMode::Unbounded)
+		{
+			ring = std::make_unique<RingBuffer<T>>(options.capacity, options.mode == ReceiverMode::MPSC);
+		}
+	}
+
+	template <typename... Args>
+	void emplace(Args &&...args)
+	{
+		if (ring)
+		{
+			if (auto dropped = ring->push(overflow, std::forward<Args>(args)...))
+			{
+				dropped_count.fetch_add(dropped, std::memory_order_relaxed);
+			}
+#if defined(REMUS_EVENT_TRACING)
+			// size() loads the consumer's head, so the producer only touches its line when tracing
+			trace_depth(ring->size());
+#endif
+		}
+		else if (latest)
+		{
+			// senders take turns writing, the receiver does not take the mutex
+			std::lock_guard<std::mutex> lock(mutex);
+			write_latest(T(std::forward<Args>(args)...), 0);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (key)
+			{
+				coalesce(T(std::forward<Args>(args)...));
+			}
+			else
+			{
+				events.emplace_back(std::forward<Args>(args)...);
+				trace_enqueued(1);
+			}
+		}
+		notify();
+	}
+
+	void receive(const T *batch, size_t count)
+	{
+		if (ring)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				emplace(batch[i]);
+			}
+			return;
+		}
 
-	void receive(T event)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (latest)
+			{
+				// every event but the last would be replaced straight away
+				write_latest(batch[count - 1], count - 1);
+			}
+			else if (key)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					coalesce(T(batch[i]));
+				}
+			}
+			else
+			{
+				events.insert(events.end(), batch, batch + count);
+				trace_enqueued(count);
+			}
+		}
+		notify();
+	}
+
+	// called with the mutex held, skipped counts the events of a batch never written
+	template <typename U>
+	void write_latest(U &&event, size_t skipped)
 	{
+		if (latest->write(std::forward<U>(event)))
+		{
+			skipped++;
+		}
+		if (skipped)
+		{
+			dropped_count.fetch_add(skipped, std::memory_order_relaxed);
+		}
+		trace_depth(1);
+	}
+
+	// called with the mutex held, replace the queued event with the same key or queue the event behind the others
+	void coalesce(T &&event)
+	{
+		auto event_key = key(event);
+		auto queued    = queued_keys.find(event_key);
+		if (queued != queued_keys.end())
+		{
+			events[queued->second - dequeued_count] = std::move(event);
+			dropped_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		queued_keys.emplace(event_key, dequeued_count + events.size());
+		events.push_back(std::move(event));
+		trace_enqueued(1);
+	}
+
+	// called with the mutex held before the count oldest events are moved out of the deque
+	void forget_keys(size_t count)
+	{
+		if (!key)
+		{
+			return;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			queued_keys.erase(key(events[i]));
+		}
+		dequeued_count += count;
+	}
+
+	// the ring and the latest slot are read without taking the mutex
+	bool lock_free() const
+	{
+		return ring || latest;
+	}
+
+	// pop from the ring or the latest slot, recording how long the event was queued
+	bool pop(T *event)
+	{
+#if defined(REMUS_EVENT_TRACING)
+		uint64_t enqueue_time;
+		if (ring ? !ring->try_pop(event, &enqueue_time) : !latest->read(event, &enqueue_time))
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(trace_mutex);
+		received_count++;
+		latency.record(trace_clock() - enqueue_time);
+		return true;
+#else
+		return ring ? ring->try_pop(event) : latest->read(event);
+#endif
+	}
+
+	// the tracing hooks of the deque, called with the mutex held, they compile to nothing without REMUS_EVENT_TRACING
+	void trace_enqueued(size_t count)
+	{
+#if defined(REMUS_EVENT_TRACING)
+		enqueue_times.insert(enqueue_times.end(), count, trace_clock());
+		trace_depth(events.size());
+#else
+		(void) count;
+#endif
+	}
+
+	void trace_dequeued(size_t count)
+	{
+#if defined(REMUS_EVENT_TRACING)
+		auto now = trace_clock();
+
+		std::lock_guard<std::mutex> lock(trace_mutex);
+		received_count += count;
+		for (size_t i = 0; i < count; ++i)
+		{
+			latency.record(now - enqueue_times[i]);
+		}
+		enqueue_times.erase(enqueue_times.begin(), enqueue_times.begin() + count);
+#else
+		(void) count;
+#endif
+	}
+
+	void trace_depth(size_t depth)
+	{
+#if defined(REMUS_EVENT_TRACING)
+		atomic_max(high_water, depth);
+		if (name)
+		{
+			TracyPlot(name, static_cast<int64_t>(depth));
+		}
+#else
+		(void) depth;
+#endif
+	}
+
+	// wake anything waiting for an event, only a fence and a load when nothing is
+	void notify()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) == 0)
+		{
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		wake_up.notify_all();
+
+#if defined(REMUS_CHANNEL_COROUTINES)
+		auto resumed = std::move(suspended);
+		suspended.clear();
+		waiters.fetch_sub(resumed.size(), std::memory_order_relaxed);
+		lock.unlock();
+
+		for (auto &coroutine : resumed)
+		{
+			if (coroutine.second)
+			{
+				coroutine.second->submit([handle = coroutine.first]() { handle.resume(); });
+			}
+			else
+			{
+				coroutine.first.resume();
+			}
+		}
+#endif
+	}
+
+#if defined(REMUS_CHANNEL_COROUTINES)
+	// returns false if an event arrived in the meantime and the coroutine should carry on
+	bool suspend(std::coroutine_handle<> handle, ThreadPool *thread_pool)
+	{
+		std::lock_guard<std::mutex> lock(wait_mutex);
+		waiters.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (!empty())
+		{
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		suspended.emplace_back(handle, thread_pool);
+		return true;
+	}
+#endif
+
+	bool empty() const
+	{
+		if (ring)
+		{
+			return ring->empty();
+		}
+		if (latest)
+		{
+			return !latest->has_unread();
+		}
+
 		std::lock_guard<std::mutex> lock(mutex);
-		events.push_back(event);
+		return events.empty();
 	}
 
 	mutable std::mutex mutex;
 	std::deque<T>      events;
+
+	// set when coalescing by key, the position in the deque of each queued key is its index minus dequeued_count
+	std::function<size_t(const T &)>     key;
+	std::unordered_map<size_t, uint64_t> queued_keys;
+	uint64_t                             dequeued_count{0};
+
+	// set for the bounded modes, which do not use the mutex
+	std::unique_ptr<RingBuffer<T>> ring;
+	OverflowPolicy                 overflow;
+	std::atomic<size_t>            dropped_count{0};
+
+	// set for ReceiverMode::Latest, written under the mutex and read without it
+	std::unique_ptr<TripleBuffer<T>> latest;
+
+	const char *name;
+
+#if defined(REMUS_EVENT_TRACING)
+	std::deque<uint64_t> enqueue_times;        // of the events in the deque, guarded by mutex
+	std::atomic<size_t>  high_water{0};
+
+	mutable std::mutex trace_mutex;
+	uint64_t           received_count{0};
+	LatencyHistogram   latency;
+#endif
+
+	// threads and coroutines waiting for an event
+	std::mutex              wait_mutex;
+	std::condition_variable wake_up;
+	std::atomic<size_t>     waiters{0};
+
+#if defined(REMUS_CHANNEL_COROUTINES)
+	std::vector<std::pair<std::coroutine_handle<>, ThreadPool *>> suspended;
+#endif
 };
 
+/* Owns the subscription of a receiver to a channel.
+ * Destroying or resetting the handle unsubscribes the receiver, the channel must outlive its handles.
+ */
+template <typename T>
+class ReceiverHandle
+{
+  public:
+	friend class Channel<T>;
+
+	ReceiverHandle() = default;
+
+	~ReceiverHandle()
+	{
+		reset();
+	}
+
+	ReceiverHandle(ReceiverHandle &&other) noexcept :
+	    channel(other.channel),
+	    receiver(std::move(other.receiver))
+	{
+		other.channel = nullptr;
+	}
+
+	ReceiverHandle &operator=(ReceiverHandle &&other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			channel       = other.channel;
+			receiver      = std::move(other.receiver);
+			other.channel = nullptr;
+		}
+		return *this;
+	}
+
+	ReceiverHandle(const ReceiverHandle &)            = delete;
+	ReceiverHandle &operator=(const ReceiverHandle &) = delete;
+
+	// unsubscribe, events sent from now on are not received
+	void reset()
+	{
+		if (channel)
+		{
+			channel->unsubscribe(receiver.get());
+			channel = nullptr;
+		}
+		receiver.reset();
+	}
+
+	Receiver<T> *get() const
+	{
+		return receiver.get();
+	}
+
+	Receiver<T> *operator->() const
+	{
+		return receiver.get();
+	}
+
+	Receiver<T> &operator*() const
+	{
+		return *receiver;
+	}
+
+	explicit operator bool() const
+	{
+		return receiver != nullptr;
+	}
+
+  private:
+	ReceiverHandle(Channel<T> *channel, std::shared_ptr<Receiver<T>> receiver) :
+	    channel(channel),
+	    receiver(std::move(receiver))
+	{}
+
+	Channel<T>                  *channel{nullptr};
+	std::shared_ptr<Receiver<T>> receiver;
+};
 }        // namespace remus
 
 namespace remus
 {
 template <typename T>
-Receiver<T> *Channel<T>::receiver()
+ReceiverHandle<T> Channel<T>::receiver(const ReceiverOptions &options)
 {
-	std::unique_lock<std::shared_mutex> lock(mutex);
+	return subscribe(std::shared_ptr<Receiver<T>>(new Receiver<T>(options)));
+}
 
-	auto receiver = std::unique_ptr<Receiver<T>>(new Receiver<T>());
-	receivers.push_back(std::move(receiver));
-	return receivers.back().get();
+template <typename T>
+ReceiverHandle<T> Channel<T>::coalescing_receiver(std::function<size_t(const T &)> key, const char *name)
+{
+	if (!key)
+	{
+		throw std::runtime_error("A coalescing receiver needs a key");
+	}
+
+	ReceiverOptions options;
+	options.name = name;
+	return subscribe(std::shared_ptr<Receiver<T>>(new Receiver<T>(options, std::move(key))));
+}
+
+template <typename T>
+ReceiverHandle<T> Channel<T>::subscribe(std::shared_ptr<Receiver<T>> receiver)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto updated = std::make_unique<Receivers>(receivers.current());
+	updated->push_back(receiver);
+	receivers.replace(std::move(updated));
+
+	return ReceiverHandle<T>(this, std::move(receiver));
+}
+
+template <typename T>
+void Channel<T>::unsubscribe(const Receiver<T> *receiver)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto &current = receivers.current();
+	auto  updated = std::make_unique<Receivers>();
+	updated->reserve(current.size());
+	for (auto &subscribed : current)
+	{
+		if (subscribed.get() != receiver)
+		{
+			updated->push_back(subscribed);
+		}
+	}
+	receivers.replace(std::move(updated));
+}
+
+template <typename T>
+void Channel<T>::synchronize()
+{
+	receivers.synchronize();
 }
 
 template <typename T>
 Sender<T> *Channel<T>::sender()
 {
-	std::unique_lock<std::shared_mutex> lock(mutex);
+	std::lock_guard<std::mutex> lock(mutex);
 
 	auto sender = std::unique_ptr<Sender<T>>(new Sender<T>(this));
 	senders.push_back(std::move(sender));
 	return senders.back().get();
 }
 
+template <typename T>
+ChannelStats Channel<T>::stats() const
+{
+	ChannelStats stats;
+#if defined(REMUS_EVENT_TRACING)
+	stats.sent = sent_count.load(std::memory_order_relaxed);
+#endif
+
+	Reader current(receivers);
+	for (auto &receiver : *current)
+	{
+		auto receiver_stats = receiver->stats();
+		stats.received += receiver_stats.received;
+		stats.dropped += receiver_stats.dropped;
+		stats.high_water = std::max(stats.high_water, receiver_stats.high_water);
+		stats.latency.merge(receiver_stats.latency);
+	}
+	return stats;
+}
+
 template <typename T>
 void Channel<T>::send(const T &event) const
 {
-	std::shared_lock<std::shared_mutex> lock(mutex);
+	trace_sent(1);
+	Reader current(receivers);
+
+	for (auto &receiver : *current)
+	{
+		receiver->emplace(event);
+	}
+}
+
+template <typename T>
+void Channel<T>::send(T &&event) const
+{
+	trace_sent(1);
+	Reader current(receivers);
+
+	if (current->empty())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i + 1 < current->size(); ++i)
+	{
+		(*current)[i]->emplace(static_cast<const T &>(event));
+	}
+	current->back()->emplace(std::move(event));
+}
+
+template <typename T>
+template <typename... Args>
+void Channel<T>::emplace(Args &&...args) const
+{
+	trace_sent(1);
+	Reader current(receivers);
+
+	if (current->size() == 1)
+	{
+		current->front()->emplace(std::forward<Args>(args)...);
+		return;
+	}
+
+	if (current->empty())
+	{
+		return;
+	}
+
+	// build the event once, copy it into every receiver but the last
+	T event(std::forward<Args>(args)...);
+	for (size_t i = 0; i + 1 < current->size(); ++i)
+	{
+		(*current)[i]->emplace(static_cast<const T &>(event));
+	}
+	current->back()->emplace(std::move(event));
+}
+
+template <typename T>
+void Channel<T>::send_batch(const T *events, size_t count) const
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	trace_sent(count);
+	Reader current(receivers);
 
-	for (auto &receiver : receivers)
+	for (auto &receiver : *current)
 	{
-		receiver->receive(event);
+		receiver->receive(events, count);
 	}
 }
 }        // namespace remus
@@ -1,14 +1,45 @@
 #pragma once
 
-#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <mutex>
-#include <typeindex>
-#include <unordered_map>
+#include <vector>
+
+#include <core/thread_pool.hpp>
+
+#include "rcu_pointer.hpp"
+#include "tracing.hpp"
+
+#if defined(REMUS_EVENT_TRACING)
+#	include <cstring>
+#	include <typeinfo>
+#endif
 
 namespace remus
 {
 class EventBus;
 
+namespace detail
+{
+inline size_t next_event_type_id()
+{
+	static std::atomic<size_t> next{0};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+}        // namespace detail
+
+// a dense index per event type, assigned once when the program starts, used to index the dispatch tables of the bus
+template <typename T>
+struct EventType
+{
+	inline static const size_t id = detail::next_event_type_id();
+
+#if defined(REMUS_EVENT_TRACING)
+	inline static const char *name = typeid(T).name();
+#endif
+};
+
 // the most basic event handler
 class EventBusObserver
 {
@@ -57,11 +88,27 @@ class EventHandler : public EventHandlerBase, public TypedEventHandler<T>...
 
 	void enable(EventBus &bus);
 
+	// unbind from the bus without waiting, a publish already running, on this thread or another, may still call the handler
+	void disable();
+
+	/*
+	 * Unbind from the bus and wait for publishes on other threads which may still call the handler, so that it can be destroyed.
+	 * It must not be called from a publish or dispatch_queued() on the same bus, which would wait for itself.
+	 * The destructor only disables, handlers published to from other threads should call this first thing in their own destructor.
+	 */
+	void disable_and_wait();
+
   private:
 	EventBus *bus{nullptr};
 };
 
-// a simple event bus
+/* Calls the handlers bound to an event type when an event of that type is published.
+ * Handlers are kept in a vector per event type, indexed by EventType<T>::id, in the order they were bound.
+ * Each handler is a delegate, an object pointer and a function pointer, so dispatching does not allocate or hash.
+ * The table of handlers is immutable, binding and unbinding copy it and swap it in, so publishing never waits on them.
+ * Publishes register as readers on one of two counters, a replaced table is freed once no reader can still be using it.
+ * Events can also be queued from any thread and published together at a sync point with dispatch_queued().
+ */
 class EventBus
 {
   public:
@@ -87,45 +134,426 @@ class EventBus
 	}
 
 	template <typename T>
-	void bind(TypedEventHandler<T> *handler)
+	void bind(TypedEventHandler<T> *handler);
+
+	// a publish which started before the call may still reach the handler
+	template <typename T>
+	void unbind(TypedEventHandler<T> *handler);
+
+	// bind or unbind a handler for every type it handles, in a single swap of the table
+	template <typename... T>
+	void bind(EventHandler<T...> &handler);
+
+	template <typename... T>
+	void unbind(EventHandler<T...> &handler);
+
+	// call every handler bound to T on this thread, handlers may publish, bind and unbind
+	template <typename T>
+	void publish(const T &event);
+
+	// queue an event for the next dispatch_queued(), from any thread, without taking a bus lock
+	template <typename T>
+	void enqueue(T event);
+
+	/*
+	 * Publish every queued event, grouped by type, in the order they were queued within a type.
+	 * With a thread pool different event types are published concurrently, the handlers of one type run in order.
+	 * Events queued by handlers are published by the next call, handlers bound by handlers are not called until then.
+	 */
+	void dispatch_queued(ThreadPool *thread_pool = nullptr);
+
+	// the time spent in every handler bound so far, empty unless built with REMUS_EVENT_TRACING
+	std::vector<HandlerStats> handler_stats();
+
+	// wait until every publish which started before the call is done, the caller must not be publishing on this bus
+	void synchronize();
+
+  private:
+	template <typename... T>
+	friend class EventHandler;
+
+#if defined(REMUS_EVENT_TRACING)
+	struct HandlerTiming
 	{
-		std::lock_guard<std::mutex> lock(mutex);
+		const void           *handler;
+		const char           *event;
+		std::atomic<uint64_t> calls{0};
+		std::atomic<uint64_t> total_ns{0};
+		std::atomic<uint64_t> max_ns{0};
 
-		handlers[std::type_index(typeid(T))][handler] = [handler](void *event) {
-			handler->handle(*static_cast<T *>(event));
-		};
-	}
+		void record(uint64_t nanoseconds)
+		{
+			calls.fetch_add(1, std::memory_order_relaxed);
+			total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+			atomic_max(max_ns, nanoseconds);
+		}
+	};
+#endif
+
+	struct Delegate
+	{
+		void *handler;
+		void (*function)(void *handler, const void *event);
+#if defined(REMUS_EVENT_TRACING)
+		HandlerTiming *timing;
+#endif
+	};
+
+	using HandlerTable = std::vector<std::vector<Delegate>>;
 
 	template <typename T>
-	void unbind(TypedEventHandler<T> *handler)
+	static void invoke(void *handler, const void *event)
+	{
+		static_cast<TypedEventHandler<T> *>(handler)->handle(*static_cast<const T *>(event));
+	}
+
+	static void dispatch(const HandlerTable &table, size_t type, const void *event)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
+		if (type >= table.size())
+		{
+			return;
+		}
 
-		handlers[std::type_index(typeid(T))].erase(handler);
+		for (auto &delegate : table[type])
+		{
+#if defined(REMUS_EVENT_TRACING)
+			ZoneScopedN("Event handler");
+			ZoneText(delegate.timing->event, std::strlen(delegate.timing->event));
+
+			auto start = trace_clock();
+			delegate.function(delegate.handler, event);
+			delegate.timing->record(trace_clock() - start);
+#else
+			delegate.function(delegate.handler, event);
+#endif
+		}
 	}
 
-  private:
-	std::mutex mutex;
+	// a delegate calling handler, called with the mutex held
+	template <typename T>
+	Delegate delegate_for(TypedEventHandler<T> *handler);
+
+	template <typename T>
+	static void add(HandlerTable &table, const Delegate &delegate);
 
-	std::unordered_map<std::type_index, std::unordered_map<EventBusObserver *, std::function<void(void *)>>> handlers;
+	template <typename T>
+	static void remove(HandlerTable &table, TypedEventHandler<T> *handler);
+
+	// registers a publish as a reader of the current table for its lifetime
+	using Reader = RcuPointer<HandlerTable>::Reader;
+
+	// copy the table, let func modify the copy and swap it in
+	template <typename Func>
+	void update(Func &&func);
+
+	// the events queued for one type
+	struct QueueBase
+	{
+		virtual ~QueueBase() = default;
+
+		virtual bool empty() = 0;
+
+		virtual void dispatch(const HandlerTable &table) = 0;
+
+		std::mutex mutex;
+	};
+
+	template <typename T>
+	struct Queue : QueueBase
+	{
+		std::vector<T> events;
+		std::vector<T> dispatching;        // swapped with events while they are published, keeping both allocations
+
+		bool empty() override
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return events.empty();
+		}
+
+		void dispatch(const HandlerTable &table) override
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				std::swap(events, dispatching);
+			}
+
+			for (auto &event : dispatching)
+			{
+				EventBus::dispatch(table, EventType<T>::id, &event);
+			}
+			dispatching.clear();
+		}
+	};
+
+	template <typename T>
+	Queue<T> &queue_of();
+
+	// serialises changes to the handlers, publishing does not take it
+	std::mutex               mutex;
+	RcuPointer<HandlerTable> handlers;
+
+#if defined(REMUS_EVENT_TRACING)
+	// kept when handlers are unbound, guarded by mutex
+	std::vector<std::unique_ptr<HandlerTiming>> timings;
+#endif
+
+	// the queues indexed by event type, the table is replaced when a type is queued for the first time
+	// and the old tables are kept until the bus is destroyed, so looking up a queue does not lock
+	using QueueTable = std::vector<QueueBase *>;
+
+	std::atomic<const QueueTable *>          queue_table{nullptr};
+	std::mutex                               queues_mutex;
+	std::vector<std::unique_ptr<QueueBase>>  queues;
+	std::vector<std::unique_ptr<QueueTable>> queue_tables;
+
+	std::mutex               dispatch_mutex;
+	std::vector<QueueBase *> pending;
 };
 }        // namespace remus
 
 namespace remus
 {
+template <typename T>
+EventBus::Delegate EventBus::delegate_for(TypedEventHandler<T> *handler)
+{
+#if defined(REMUS_EVENT_TRACING)
+	HandlerTiming *timing = nullptr;
+	for (auto &existing : timings)
+	{
+		if (existing->handler == handler && existing->event == EventType<T>::name)
+		{
+			timing = existing.get();
+			break;
+		}
+	}
+	if (!timing)
+	{
+		timings.push_back(std::make_unique<HandlerTiming>());
+		timing          = timings.back().get();
+		timing->handler = handler;
+		timing->event   = EventType<T>::name;
+	}
+	return {handler, &EventBus::invoke<T>, timing};
+#else
+	return {handler, &EventBus::invoke<T>};
+#endif
+}
+
+inline std::vector<HandlerStats> EventBus::handler_stats()
+{
+	std::vector<HandlerStats> stats;
+#if defined(REMUS_EVENT_TRACING)
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &timing : timings)
+	{
+		HandlerStats handler;
+		handler.handler  = timing->handler;
+		handler.event    = timing->event;
+		handler.calls    = timing->calls.load(std::memory_order_relaxed);
+		handler.total_ns = timing->total_ns.load(std::memory_order_relaxed);
+		handler.max_ns   = timing->max_ns.load(std::memory_order_relaxed);
+		stats.push_back(handler);
+	}
+#endif
+	return stats;
+}
+
+template <typename T>
+void EventBus::add(HandlerTable &table, const Delegate &delegate)
+{
+	auto type = EventType<T>::id;
+	if (type >= table.size())
+	{
+		table.resize(type + 1);
+	}
+
+	auto &delegates = table[type];
+	for (auto &existing : delegates)
+	{
+		if (existing.handler == delegate.handler)
+		{
+			return;
+		}
+	}
+	delegates.push_back(delegate);
+}
+
+template <typename T>
+void EventBus::remove(HandlerTable &table, TypedEventHandler<T> *handler)
+{
+	auto type = EventType<T>::id;
+	if (type >= table.size())
+	{
+		return;
+	}
+
+	auto &delegates = table[type];
+	for (auto it = delegates.begin(); it != delegates.end(); ++it)
+	{
+		if (it->handler == handler)
+		{
+			delegates.erase(it);
+			return;
+		}
+	}
+}
+
+template <typename Func>
+void EventBus::update(Func &&func)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto updated = std::make_unique<HandlerTable>(handlers.current());
+	func(*updated);
+	handlers.replace(std::move(updated));
+}
+
+inline void EventBus::synchronize()
+{
+	handlers.synchronize();
+}
+
+template <typename T>
+void EventBus::bind(TypedEventHandler<T> *handler)
+{
+	update([this, handler](HandlerTable &table) { add<T>(table, delegate_for<T>(handler)); });
+}
+
+template <typename T>
+void EventBus::unbind(TypedEventHandler<T> *handler)
+{
+	update([handler](HandlerTable &table) { remove<T>(table, handler); });
+}
+
 template <typename... T>
-EventHandler<T...>::~EventHandler()
+void EventBus::bind(EventHandler<T...> &handler)
 {
-	if (bus)
+	update([this, &handler](HandlerTable &table) { (add<T>(table, delegate_for<T>(&handler)), ...); });
+}
+
+template <typename... T>
+void EventBus::unbind(EventHandler<T...> &handler)
+{
+	update([&handler](HandlerTable &table) { (remove<T>(table, &handler), ...); });
+}
+
+template <typename T>
+void EventBus::publish(const T &event)
+{
+	Reader table(handlers);
+	dispatch(*table, EventType<T>::id, &event);
+}
+
+template <typename T>
+void EventBus::enqueue(T event)
+{
+	auto &queue = queue_of<T>();
+
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	queue.events.push_back(std::move(event));
+}
+
+template <typename T>
+EventBus::Queue<T> &EventBus::queue_of()
+{
+	auto  type  = EventType<T>::id;
+	auto *table = queue_table.load(std::memory_order_acquire);
+	if (table && type < table->size() && (*table)[type])
 	{
-		(bus->unbind<T>(this), ...);
+		return static_cast<Queue<T> &>(*(*table)[type]);
+	}
+
+	std::lock_guard<std::mutex> lock(queues_mutex);
+
+	// another thread may have added it in the meantime
+	table = queue_table.load(std::memory_order_relaxed);
+	if (table && type < table->size() && (*table)[type])
+	{
+		return static_cast<Queue<T> &>(*(*table)[type]);
+	}
+
+	auto updated = table ? std::make_unique<QueueTable>(*table) : std::make_unique<QueueTable>();
+	if (type >= updated->size())
+	{
+		updated->resize(type + 1, nullptr);
+	}
+
+	queues.push_back(std::make_unique<Queue<T>>());
+	(*updated)[type] = queues.back().get();
+
+	queue_table.store(updated.get(), std::memory_order_release);
+	queue_tables.push_back(std::move(updated));
+
+	return static_cast<Queue<T> &>(*queues.back());
+}
+
+inline void EventBus::dispatch_queued(ThreadPool *thread_pool)
+{
+	std::lock_guard<std::mutex> lock(dispatch_mutex);
+
+	pending.clear();
+	if (auto *table = queue_table.load(std::memory_order_acquire))
+	{
+		for (auto *queue : *table)
+		{
+			if (queue && !queue->empty())
+			{
+				pending.push_back(queue);
+			}
+		}
+	}
+
+	// one table for the whole sync point
+	Reader table(handlers);
+
+	if (thread_pool && pending.size() > 1)
+	{
+		thread_pool->parallel_for(pending.size(), 1, [this, &table](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				pending[i]->dispatch(*table);
+			}
+		});
+		return;
+	}
+
+	for (auto *queue : pending)
+	{
+		queue->dispatch(*table);
 	}
 }
 
+template <typename... T>
+EventHandler<T...>::~EventHandler()
+{
+	disable();
+}
+
 template <typename... T>
 void EventHandler<T...>::enable(EventBus &bus)
 {
-	(bus.bind<T>(this), ...);
+	bus.bind(*this);
 	this->bus = &bus;
 }
+
+template <typename... T>
+void EventHandler<T...>::disable()
+{
+	if (bus)
+	{
+		bus->unbind(*this);
+		bus = nullptr;
+	}
+}
+
+template <typename... T>
+void EventHandler<T...>::disable_and_wait()
+{
+	if (bus)
+	{
+		auto *unbound = bus;
+		disable();
+		unbound->synchronize();
+	}
+}
 }        // namespace remus
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace remus
+{
+/* Points to an immutable value replaced whole on every change (read-copy-update).
+ * Readers load the current value through a plain atomic pointer and never wait on it being replaced.
+ * Readers register on one of two counters, a replaced value is retired and freed once each counter has been seen at zero since,
+ * as a reader still using it would have been counted all along.
+ * Each replacement checks the counters and flips the epoch so that new readers move to the other counter and the one in use drains,
+ * the reader leaving a counter at zero checks them again while values are retired. Only synchronize() waits.
+ * Replacements must be serialised by the caller.
+ */
+template <typename T>
+class RcuPointer
+{
+  public:
+	RcuPointer() = default;
+
+	RcuPointer(const RcuPointer &)            = delete;
+	RcuPointer(RcuPointer &&)                 = delete;
+	RcuPointer &operator=(const RcuPointer &) = delete;
+	RcuPointer &operator=(RcuPointer &&)      = delete;
+
+	// registers as a reader of the current value for its lifetime
+	class Reader
+	{
+	  public:
+		explicit Reader(RcuPointer &pointer) :
+		    pointer(pointer),
+		    index(pointer.epoch.load(std::memory_order_relaxed) & 1)
+		{
+			pointer.readers[index].fetch_add(1, std::memory_order_seq_cst);
+			value = pointer.published.load(std::memory_order_seq_cst);
+#if !defined(NDEBUG)
+			outer     = innermost;
+			innermost = this;
+#endif
+		}
+
+		~Reader()
+		{
+#if !defined(NDEBUG)
+			innermost = outer;
+#endif
+			if (pointer.readers[index].fetch_sub(1, std::memory_order_seq_cst) == 1 && pointer.reclaiming.load(std::memory_order_seq_cst))
+			{
+				pointer.try_reclaim();
+			}
+		}
+
+		Reader(const Reader &)            = delete;
+		Reader &operator=(const Reader &) = delete;
+
+		const T &operator*() const
+		{
+			return *value;
+		}
+
+		const T *operator->() const
+		{
+			return value;
+		}
+
+	  private:
+		friend class RcuPointer;
+
+		RcuPointer &pointer;
+		size_t      index;
+		const T    *value;
+
+#if !defined(NDEBUG)
+		// the readers open on this thread, innermost first, so that synchronize() can tell it would wait for itself
+		static inline thread_local const Reader *innermost = nullptr;
+		const Reader                            *outer     = nullptr;
+#endif
+	};
+
+	// the current value, for the caller replacing it
+	const T &current() const
+	{
+		return *owned;
+	}
+
+	// swap in a new value, the old one is retired
+	void replace(std::unique_ptr<const T> updated);
+
+	// wait until every reader which started before the call is done and free the retired values
+	// the caller must not be reading, which debug builds check for readers on the calling thread
+	void synchronize();
+
+  private:
+	struct Retired
+	{
+		std::unique_ptr<const T> value;
+		bool                     drained[2]{false, false};        // the counter was seen at zero since the value was replaced
+	};
+
+	// move the retired values no reader can be using into reclaimed, called with mutex held
+	void reclaim(std::vector<Retired> &reclaimed);
+
+	// reclaim unless another thread is already, a reader must not wait
+	void try_reclaim();
+
+	// guards retired, readers only take it when leaving a counter at zero while values are retired
+	std::mutex               mutex;
+	std::unique_ptr<const T> owned{std::make_unique<const T>()};
+	std::atomic<const T *>   published{owned.get()};
+	std::vector<Retired>     retired;
+	std::atomic<bool>        reclaiming{false};
+
+	// readers count into the counter of the epoch they started in
+	std::mutex          synchronize_mutex;
+	std::atomic<size_t> epoch{0};
+	std::atomic<size_t> readers[2]{};
+};
+
+template <typename T>
+void RcuPointer<T>::replace(std::unique_ptr<const T> updated)
+{
+	// freed once the mutex is released
+	std::vector<Retired> reclaimed;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	retired.push_back({std::move(owned)});
+	owned = std::move(updated);
+	published.store(owned.get(), std::memory_order_seq_cst);
+
+	// set before the counters are read, so a reader leaving after that sees it and checks them again
+	reclaiming.store(true, std::memory_order_seq_cst);
+	reclaim(reclaimed);
+}
+
+template <typename T>
+void RcuPointer<T>::reclaim(std::vector<Retired> &reclaimed)
+{
+	// readers start by counting themselves, a reader which is not counted yet will load the new value
+	for (size_t index = 0; index < 2; ++index)
+	{
+		if (readers[index].load(std::memory_order_seq_cst) == 0)
+		{
+			for (auto &value : retired)
+			{
+				value.drained[index] = true;
+			}
+		}
+	}
+
+	auto drained = std::stable_partition(retired.begin(), retired.end(), [](const Retired &value) { return !(value.drained[0] && value.drained[1]); });
+	std::move(drained, retired.end(), std::back_inserter(reclaimed));
+	retired.erase(drained, retired.end());
+
+	if (!retired.empty())
+	{
+		// new readers move to the other counter, so the one in use drains
+		epoch.fetch_add(1, std::memory_order_relaxed);
+	}
+	reclaiming.store(!retired.empty(), std::memory_order_seq_cst);
+}
+
+template <typename T>
+void RcuPointer<T>::try_reclaim()
+{
+	// freed once the mutex is released
+	std::vector<Retired> reclaimed;
+
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (lock)
+	{
+		reclaim(reclaimed);
+	}
+}
+
+template <typename T>
+void RcuPointer<T>::synchronize()
+{
+#if !defined(NDEBUG)
+	for (auto *reader = Reader::innermost; reader; reader = reader->outer)
+	{
+		if (&reader->pointer == this)
+		{
+			throw std::runtime_error("Cannot synchronize from one of its own readers");
+		}
+	}
+#endif
+
+	std::vector<Retired> reclaimed;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		reclaimed.swap(retired);
+		reclaiming.store(false, std::memory_order_seq_cst);
+	}
+
+	// readers which started before the first flip drain from the old counter while new ones use the other,
+	// the second flip catches readers which read the epoch just before the first one
+	std::lock_guard<std::mutex> lock(synchronize_mutex);
+	for (int flip = 0; flip < 2; ++flip)
+	{
+		auto index = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+		while (readers[index].load(std::memory_order_acquire) != 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+}        // namespace remus
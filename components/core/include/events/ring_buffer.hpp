@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "tracing.hpp"
+
+namespace remus
+{
+// what a bounded queue does with an event which does not fit
+enum class OverflowPolicy
+{
+	DropOldest,        // discard the oldest queued event to make room
+	DropNewest,        // discard the event being pushed
+	Block              // wait until the consumer, on another thread, makes room
+};
+
+/* A bounded lock-free queue of a power of two number of slots.
+ * Every slot carries a sequence number telling producers and consumers whose turn it is (Vyukov's bounded queue).
+ * Producers claim the tail with a CAS when there may be several of them, a single producer uses a plain store.
+ * Consumers always claim the head with a CAS so that a producer can pop the oldest event to make room.
+ */
+template <typename T>
+class RingBuffer
+{
+  public:
+	RingBuffer(size_t capacity, bool multi_producer);
+	~RingBuffer();
+
+	RingBuffer(const RingBuffer &)            = delete;
+	RingBuffer(RingBuffer &&)                 = delete;
+	RingBuffer &operator=(const RingBuffer &) = delete;
+	RingBuffer &operator=(RingBuffer &&)      = delete;
+
+	size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	// number of queued events, only exact when no other thread is pushing or popping
+	size_t size() const
+	{
+		// head is loaded first, a consumer moving it on afterwards can then only make the result too large, never wrap it
+		auto position = head.load(std::memory_order_acquire);
+		return std::min(tail.load(std::memory_order_acquire) - position, capacity());
+	}
+
+	// true until the oldest event has been fully written
+	bool empty() const
+	{
+		auto position = head.load(std::memory_order_acquire);
+		return slots[position & mask].sequence.load(std::memory_order_acquire) != position + 1;
+	}
+
+	// construct an event in the next free slot, returns false without touching args if the queue is full
+	template <typename... Args>
+	bool try_emplace(Args &&...args);
+
+	// pop the oldest event into value, or discard it when value is nullptr
+	// with REMUS_EVENT_TRACING enqueue_time is set to when the event was pushed, otherwise to 0
+	bool try_pop(T *value, uint64_t *enqueue_time = nullptr);
+
+	/*
+	 * Construct an event in the queue, applying the overflow policy when it is full.
+	 * Returns the number of events dropped. Under DropOldest with several producers another producer may take the room made,
+	 * so more than one event can be dropped.
+	 */
+	template <typename... Args>
+	size_t push(OverflowPolicy policy, Args &&...args);
+
+  private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		alignas(T) unsigned char storage[sizeof(T)];
+#if defined(REMUS_EVENT_TRACING)
+		uint64_t time;
+#endif
+
+		T *get()
+		{
+			return std::launder(reinterpret_cast<T *>(storage));
+		}
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t                  mask;
+	bool                    multi_producer;
+
+	// on separate cache lines so that producers and the consumer do not invalidate each other
+	alignas(64) std::atomic<size_t> head{0};
+	alignas(64) std::atomic<size_t> tail{0};
+};
+}        // namespace remus
+
+namespace remus
+{
+template <typename T>
+RingBuffer<T>::RingBuffer(size_t capacity, bool multi_producer) :
+    multi_producer(multi_producer)
+{
+	size_t size = 2;
+	while (size < capacity)
+	{
+		size *= 2;
+	}
+
+	slots = std::unique_ptr<Slot[]>(new Slot[size]);
+	mask  = size - 1;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+RingBuffer<T>::~RingBuffer()
+{
+	while (try_pop(nullptr))
+	{
+	}
+}
+
+template <typename T>
+template <typename... Args>
+bool RingBuffer<T>::try_emplace(Args &&...args)
+{
+	Slot  *slot;
+	size_t position = tail.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		slot = &slots[position & mask];
+
+		auto sequence   = slot->sequence.load(std::memory_order_acquire);
+		auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (difference < 0)
+		{
+			// the slot still holds the event from the previous lap
+			return false;
+		}
+
+		if (difference == 0)
+		{
+			if (!multi_producer)
+			{
+				tail.store(position + 1, std::memory_order_relaxed);
+				break;
+			}
+
+			if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else
+		{
+			position = tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	new (slot->storage) T(std::forward<Args>(args)...);
+#if defined(REMUS_EVENT_TRACING)
+	slot->time = trace_clock();
+#endif
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+bool RingBuffer<T>::try_pop(T *value, uint64_t *enqueue_time)
+{
+	Slot  *slot;
+	size_t position = head.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		slot = &slots[position & mask];
+
+		auto sequence   = slot->sequence.load(std::memory_order_acquire);
+		auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+		if (difference < 0)
+		{
+			return false;
+		}
+
+		if (difference == 0)
+		{
+			if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else
+		{
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (enqueue_time)
+	{
+#if defined(REMUS_EVENT_TRACING)
+		*enqueue_time = slot->time;
+#else
+		*enqueue_time = 0;
+#endif
+	}
+
+	auto *event = slot->get();
+	if (value)
+	{
+		*value = std::move(*event);
+	}
+	event->~T();
+
+	slot->sequence.store(position + mask + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+template <typename... Args>
+size_t RingBuffer<T>::push(OverflowPolicy policy, Args &&...args)
+{
+	// try_emplace only consumes the arguments once it succeeds
+	size_t dropped = 0;
+	while (!try_emplace(std::forward<Args>(args)...))
+	{
+		switch (policy)
+		{
+			case OverflowPolicy::DropOldest:
+				// another consumer may have made room in the meantime, in which case nothing is dropped
+				if (try_pop(nullptr))
+				{
+					++dropped;
+				}
+				break;
+			case OverflowPolicy::DropNewest:
+				return 1;
+			case OverflowPolicy::Block:
+				std::this_thread::yield();
+				break;
+		}
+	}
+	return dropped;
+}
+}        // namespace remus
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(REMUS_EVENT_TRACING)
+#	include <tracy/Tracy.hpp>
+#endif
+
+namespace remus
+{
+// nanoseconds on a steady clock, used to time events and handlers
+inline uint64_t trace_clock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// a histogram of durations in power of two buckets of nanoseconds
+struct LatencyHistogram
+{
+	// bucket i counts durations in [2^i, 2^(i + 1)), bucket 0 also counts 0
+	static constexpr size_t bucket_count = 40;
+
+	std::array<uint64_t, bucket_count> buckets{};
+
+	void record(uint64_t nanoseconds)
+	{
+		size_t bucket = 0;
+		while (nanoseconds > 1 && bucket + 1 < bucket_count)
+		{
+			nanoseconds >>= 1;
+			bucket++;
+		}
+		buckets[bucket]++;
+	}
+
+	void merge(const LatencyHistogram &other)
+	{
+		for (size_t i = 0; i < bucket_count; ++i)
+		{
+			buckets[i] += other.buckets[i];
+		}
+	}
+
+	uint64_t count() const
+	{
+		uint64_t total = 0;
+		for (auto bucket : buckets)
+		{
+			total += bucket;
+		}
+		return total;
+	}
+
+	// the upper bound of the bucket below which the fraction of durations falls, 0 when empty
+	uint64_t percentile(double fraction) const
+	{
+		auto total = count();
+		if (total == 0)
+		{
+			return 0;
+		}
+
+		auto     target     = static_cast<uint64_t>(fraction * static_cast<double>(total));
+		uint64_t cumulative = 0;
+		for (size_t i = 0; i < bucket_count; ++i)
+		{
+			cumulative += buckets[i];
+			if (cumulative > target || cumulative == total)
+			{
+				return uint64_t{2} << i;
+			}
+		}
+		return uint64_t{2} << (bucket_count - 1);
+	}
+};
+
+// statistics of a receiver, or of every receiver of a channel, empty unless built with REMUS_EVENT_TRACING
+struct ReceiverStats
+{
+	uint64_t         received{0};
+	uint64_t         dropped{0};
+	size_t           high_water{0};        // the most events queued at once
+	LatencyHistogram latency;              // from being sent to being received
+};
+
+struct ChannelStats : ReceiverStats
+{
+	uint64_t sent{0};
+};
+
+// time spent in a handler of an event type, empty unless built with REMUS_EVENT_TRACING
+struct HandlerStats
+{
+	const void *handler{nullptr};
+	const char *event{nullptr};        // the implementation defined name of the event type
+	uint64_t    calls{0};
+	uint64_t    total_ns{0};
+	uint64_t    max_ns{0};
+};
+
+// raise value to at least candidate
+template <typename T>
+void atomic_max(std::atomic<T> &value, T candidate)
+{
+	auto current = value.load(std::memory_order_relaxed);
+	while (current < candidate && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+	{
+	}
+}
+}        // namespace remus
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "tracing.hpp"
+
+namespace remus
+{
+/* Holds the latest value written, older unread values are overwritten.
+ * The writer and the reader each own one of three buffers and swap it with the shared middle one by atomic exchange,
+ * so neither waits for the other. Writes must come from one thread at a time, reads from one thread at a time.
+ */
+template <typename T>
+class TripleBuffer
+{
+  public:
+	TripleBuffer() = default;
+
+	TripleBuffer(const TripleBuffer &)            = delete;
+	TripleBuffer(TripleBuffer &&)                 = delete;
+	TripleBuffer &operator=(const TripleBuffer &) = delete;
+	TripleBuffer &operator=(TripleBuffer &&)      = delete;
+
+	// returns true if an unread value was overwritten
+	template <typename U>
+	bool write(U &&value)
+	{
+		buffers[back].value = std::forward<U>(value);
+#if defined(REMUS_EVENT_TRACING)
+		buffers[back].time = trace_clock();
+#endif
+
+		auto previous = middle.exchange(back | unread, std::memory_order_acq_rel);
+		back          = previous & index_mask;
+		return (previous & unread) != 0;
+	}
+
+	// move the latest value into value, or discard it when value is nullptr, returns false if nothing was written since the last read
+	// with REMUS_EVENT_TRACING write_time is set to when the value was written, otherwise to 0
+	bool read(T *value, uint64_t *write_time = nullptr)
+	{
+		if (!has_unread())
+		{
+			return false;
+		}
+
+		front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+
+		if (value)
+		{
+			*value = std::move(*buffers[front].value);
+		}
+		if (write_time)
+		{
+#if defined(REMUS_EVENT_TRACING)
+			*write_time = buffers[front].time;
+#else
+			*write_time = 0;
+#endif
+		}
+		return true;
+	}
+
+	bool has_unread() const
+	{
+		return (middle.load(std::memory_order_acquire) & unread) != 0;
+	}
+
+  private:
+	static constexpr uint8_t index_mask = 3;
+	static constexpr uint8_t unread     = 4;
+
+	struct Buffer
+	{
+		std::optional<T> value;
+#if defined(REMUS_EVENT_TRACING)
+		uint64_t time{0};
+#endif
+	};
+
+	Buffer buffers[3];
+
+	uint8_t              back{0};          // owned by the writer
+	std::atomic<uint8_t> middle{1};        // index of the shared buffer, with the unread bit
+	uint8_t              front{2};         // owned by the reader
+};
+}        // namespace remus
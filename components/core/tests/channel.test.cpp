@@ -1,5 +1,11 @@
 #include <events/channel.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Send an event", "[core]")
@@ -110,3 +116,473 @@ TEST_CASE("Out of order receivers", "[core]")
 	REQUIRE(received == 0);
 	REQUIRE(receiver2->next(&received) == false);        // event is not received
 }
+
+TEST_CASE("Destroying a receiver handle unsubscribes it", "[core]")
+{
+	remus::Channel<int> channel;
+
+	auto receiver1 = channel.receiver();
+	auto receiver2 = channel.receiver();
+	auto sender    = channel.sender();
+	REQUIRE(channel.receiver_count() == 2);
+
+	sender->send(0);
+	receiver2.reset();
+	REQUIRE(!receiver2);
+	REQUIRE(channel.receiver_count() == 1);
+
+	{
+		auto moved = std::move(receiver1);
+		REQUIRE(channel.receiver_count() == 1);
+		sender->send(1);
+
+		int received;
+		REQUIRE(moved->next(&received));
+		REQUIRE(received == 0);
+		REQUIRE(moved->next(&received));
+		REQUIRE(received == 1);
+	}
+	REQUIRE(channel.receiver_count() == 0);
+
+	// nobody is listening
+	sender->send(2);
+}
+
+TEST_CASE("Unsubscribed receivers are freed once no send uses them", "[core]")
+{
+	remus::Channel<std::shared_ptr<int>> channel;
+
+	auto event    = std::make_shared<int>(0);
+	auto receiver = channel.receiver();
+	auto sender   = channel.sender();
+
+	sender->send(event);
+	REQUIRE(event.use_count() == 2);
+
+	// no send is running, so the replaced list and the receiver queue go straight away
+	receiver.reset();
+	REQUIRE(event.use_count() == 1);
+}
+
+TEST_CASE("Subscribe and unsubscribe while sending", "[core]")
+{
+	remus::Channel<int> channel;
+
+	auto receiver = channel.receiver();
+	auto sender   = channel.sender();
+
+	std::atomic<bool> done{false};
+	std::thread       producer([&]() {
+		for (int i = 0; i < 10000; ++i)
+		{
+			sender->send(i);
+		}
+		done = true;
+	});
+
+	// short lived subscriptions do not disturb the long lived one
+	while (!done)
+	{
+		auto transient = channel.receiver();
+		transient->drain(nullptr);
+	}
+	producer.join();
+	channel.synchronize();
+
+	std::vector<int> received;
+	receiver->drain_into(received);
+	REQUIRE(received.size() == 10000);
+	REQUIRE(received.back() == 9999);
+	REQUIRE(channel.receiver_count() == 1);
+}
+
+TEST_CASE("Unsubscribed receivers are freed while another thread sends", "[core]")
+{
+	using namespace std::chrono_literals;
+
+	remus::Channel<std::shared_ptr<int>> channel;
+
+	auto event  = std::make_shared<int>(0);
+	auto sender = channel.sender();
+
+	std::atomic<bool> sending{true};
+	std::thread       producer([&]() {
+		while (sending)
+		{
+			sender->send(event);
+		}
+	});
+
+	// every receiver queues copies of the event, they go with the lists replaced while the producer keeps sending
+	for (int i = 0; i < 1000; ++i)
+	{
+		auto transient = channel.receiver();
+	}
+
+	auto deadline = std::chrono::steady_clock::now() + 10s;
+	while (event.use_count() > 1 && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	sending = false;
+	producer.join();
+
+	REQUIRE(event.use_count() == 1);
+}
+
+TEST_CASE("Send and receive batches", "[core]")
+{
+	remus::ReceiverOptions bounded;
+	bounded.mode = remus::ReceiverMode::SPSC;
+
+	for (auto options : {remus::ReceiverOptions{}, bounded})
+	{
+		remus::Channel<int> channel;
+
+		auto receiver = channel.receiver(options);
+		auto sender   = channel.sender();
+
+		std::vector<int> events(10);
+		for (int i = 0; i < 10; ++i)
+		{
+			events[i] = i;
+		}
+		sender->send_batch(events.data(), events.size());
+		sender->send(10);
+
+		// received in order, a few at a time
+		int received[4];
+		REQUIRE(receiver->receive_batch(received, 4) == 4);
+		REQUIRE(received[0] == 0);
+		REQUIRE(received[3] == 3);
+		REQUIRE(receiver->receive_batch(received, 4) == 4);
+		REQUIRE(received[0] == 4);
+
+		// the rest is appended
+		std::vector<int> drained{-1};
+		REQUIRE(receiver->drain_into(drained) == 3);
+		REQUIRE(drained == std::vector<int>{-1, 8, 9, 10});
+
+		REQUIRE(receiver->receive_batch(received, 4) == 0);
+		REQUIRE(receiver->drain_into(drained) == 0);
+	}
+}
+
+namespace
+{
+// counts the copies made of it
+struct Counted
+{
+	static inline int copies = 0;
+
+	int value{0};
+
+	Counted() = default;
+	Counted(int value) :
+	    value(value)
+	{}
+	Counted(const Counted &other) :
+	    value(other.value)
+	{
+		copies++;
+	}
+	Counted(Counted &&other)                 = default;
+	Counted &operator=(Counted &&other)      = default;
+	Counted &operator=(const Counted &other) = default;
+};
+}        // namespace
+
+TEST_CASE("Events are moved into the last receiver", "[core]")
+{
+	remus::Channel<Counted> channel;
+
+	auto receiver1 = channel.receiver();
+	auto receiver2 = channel.receiver();
+	auto receiver3 = channel.receiver();
+	auto sender    = channel.sender();
+
+	Counted::copies = 0;
+	sender->send(Counted{1});
+	REQUIRE(Counted::copies == 2);
+
+	Counted::copies = 0;
+	sender->emplace(2);
+	REQUIRE(Counted::copies == 2);
+
+	Counted received;
+	for (auto receiver : {receiver1.get(), receiver2.get(), receiver3.get()})
+	{
+		REQUIRE(receiver->next(&received));
+		REQUIRE(received.value == 1);
+		REQUIRE(receiver->next(&received));
+		REQUIRE(received.value == 2);
+	}
+}
+
+TEST_CASE("Emplace into a single receiver", "[core]")
+{
+	remus::ReceiverOptions bounded;
+	bounded.mode = remus::ReceiverMode::MPSC;
+
+	for (auto options : {remus::ReceiverOptions{}, bounded})
+	{
+		remus::Channel<Counted> channel;
+
+		auto receiver = channel.receiver(options);
+		auto sender   = channel.sender();
+
+		Counted::copies = 0;
+		sender->emplace(3);
+
+		Counted received;
+		REQUIRE(receiver->next(&received));
+		REQUIRE(received.value == 3);
+		REQUIRE(Counted::copies == 0);
+	}
+}
+
+TEST_CASE("Shared events are not copied", "[core]")
+{
+	remus::Channel<remus::SharedEvent<std::vector<int>>> channel;
+
+	auto receiver1 = channel.receiver();
+	auto receiver2 = channel.receiver();
+	auto sender    = channel.sender();
+
+	sender->send(std::make_shared<const std::vector<int>>(1000, 7));
+
+	remus::SharedEvent<std::vector<int>> received1;
+	remus::SharedEvent<std::vector<int>> received2;
+	REQUIRE(receiver1->next(&received1));
+	REQUIRE(receiver2->next(&received2));
+	REQUIRE(received1 == received2);
+	REQUIRE(received1.use_count() == 2);
+	REQUIRE((*received1)[999] == 7);
+}
+
+TEST_CASE("Wait for an event", "[core]")
+{
+	using namespace std::chrono_literals;
+
+	remus::ReceiverOptions bounded;
+	bounded.mode = remus::ReceiverMode::SPSC;
+
+	remus::ReceiverOptions latest;
+	latest.mode = remus::ReceiverMode::Latest;
+
+	for (auto options : {remus::ReceiverOptions{}, bounded, latest})
+	{
+		remus::Channel<int> channel;
+
+		auto receiver = channel.receiver(options);
+		auto sender   = channel.sender();
+
+		// times out without an event
+		int received = -1;
+		REQUIRE(receiver->wait_next(&received, 1ms) == false);
+
+		// an event already queued is returned straight away
+		sender->send(0);
+		REQUIRE(receiver->wait_next(&received, 0ms));
+		REQUIRE(received == 0);
+
+		// woken by an event sent from another thread
+		std::thread producer([sender]() {
+			std::this_thread::sleep_for(10ms);
+			sender->send(1);
+		});
+		REQUIRE(receiver->wait_next(&received, 10s));
+		REQUIRE(received == 1);
+		producer.join();
+	}
+}
+
+TEST_CASE("Receive only the latest event", "[core]")
+{
+	remus::Channel<int> channel;
+
+	remus::ReceiverOptions options;
+	options.mode = remus::ReceiverMode::Latest;
+
+	auto receiver = channel.receiver(options);
+	auto sender   = channel.sender();
+
+	int received;
+	REQUIRE(receiver->next(&received) == false);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		sender->send(i);
+	}
+	REQUIRE(receiver->next(&received));
+	REQUIRE(received == 4);
+	REQUIRE(receiver->next(&received) == false);
+	REQUIRE(receiver->dropped() == 4);
+
+	// only the last event of a batch is written
+	int batch[3] = {5, 6, 7};
+	sender->send_batch(batch, 3);
+	REQUIRE(receiver->dropped() == 6);
+
+	std::vector<int> out;
+	REQUIRE(receiver->drain_into(out) == 1);
+	REQUIRE(out[0] == 7);
+
+	sender->emplace(8);
+	REQUIRE(receiver->receive_batch(batch, 3) == 1);
+	REQUIRE(batch[0] == 8);
+}
+
+namespace
+{
+struct Resize
+{
+	int window;
+	int width;
+};
+}        // namespace
+
+TEST_CASE("Coalesce events by key", "[core]")
+{
+	remus::Channel<Resize> channel;
+
+	auto receiver = channel.coalescing_receiver([](const Resize &event) { return static_cast<size_t>(event.window); });
+	auto sender   = channel.sender();
+
+	sender->send(Resize{1, 100});
+	sender->send(Resize{2, 200});
+	sender->send(Resize{1, 150});
+	sender->send(Resize{3, 300});
+	sender->send(Resize{2, 250});
+	REQUIRE(receiver->dropped() == 2);
+
+	// each window keeps the place of its first event
+	Resize received;
+	REQUIRE(receiver->next(&received));
+	REQUIRE(received.window == 1);
+	REQUIRE(received.width == 150);
+
+	// window 1 was received, so its next event queues behind the others
+	sender->send(Resize{1, 175});
+	sender->send(Resize{3, 350});
+
+	Resize batch[4];
+	REQUIRE(receiver->receive_batch(batch, 4) == 3);
+	REQUIRE(batch[0].window == 2);
+	REQUIRE(batch[0].width == 250);
+	REQUIRE(batch[1].window == 3);
+	REQUIRE(batch[1].width == 350);
+	REQUIRE(batch[2].window == 1);
+	REQUIRE(batch[2].width == 175);
+	REQUIRE(receiver->dropped() == 3);
+
+	Resize resizes[3] = {{4, 400}, {4, 450}, {5, 500}};
+	sender->send_batch(resizes, 3);
+	std::vector<Resize> out;
+	REQUIRE(receiver->drain_into(out) == 2);
+	REQUIRE(out[0].width == 450);
+	REQUIRE(out[1].width == 500);
+
+	REQUIRE_THROWS(channel.coalescing_receiver(nullptr));
+}
+
+TEST_CASE("Receive the latest event while it is being sent", "[core]")
+{
+	constexpr int event_count = 100000;
+
+	remus::Channel<Resize> channel;
+
+	remus::ReceiverOptions options;
+	options.mode = remus::ReceiverMode::Latest;
+
+	auto receiver = channel.receiver(options);
+	auto sender   = channel.sender();
+
+	std::thread producer([sender]() {
+		for (int i = 0; i < event_count; ++i)
+		{
+			sender->send(Resize{i, i});
+		}
+	});
+
+	// the events are whole and arrive in order, never the same one twice
+	int    last = -1;
+	Resize received;
+	while (last != event_count - 1)
+	{
+		if (receiver->next(&received))
+		{
+			REQUIRE(received.window == received.width);
+			REQUIRE(received.window > last);
+			last = received.window;
+		}
+	}
+	producer.join();
+
+	REQUIRE(receiver->next(&received) == false);
+}
+
+#if defined(REMUS_CHANNEL_COROUTINES)
+namespace
+{
+// a coroutine which starts straight away and is never awaited
+struct Detached
+{
+	struct promise_type
+	{
+		Detached get_return_object()
+		{
+			return {};
+		}
+		std::suspend_never initial_suspend()
+		{
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+		void return_void()
+		{}
+		void unhandled_exception()
+		{}
+	};
+};
+
+Detached sum_events(remus::Receiver<int> *receiver, int count, int &sum)
+{
+	int event;
+	for (int i = 0; i < count; ++i)
+	{
+		if (co_await receiver->next_async(&event))
+		{
+			sum += event;
+		}
+	}
+}
+}        // namespace
+
+TEST_CASE("Await events in a coroutine", "[core]")
+{
+	remus::Channel<int> channel;
+
+	auto receiver = channel.receiver();
+	auto sender   = channel.sender();
+
+	sender->send(1);
+
+	// takes the queued event then suspends until the next ones are sent
+	int sum = 0;
+	sum_events(receiver.get(), 3, sum);
+	REQUIRE(sum == 1);
+
+	sender->send(2);
+	REQUIRE(sum == 3);
+	sender->send(3);
+	REQUIRE(sum == 6);
+
+	// finished, the coroutine is no longer waiting
+	sender->send(4);
+	REQUIRE(sum == 6);
+}
+#endif
@@ -1,5 +1,10 @@
 #include <events/event_bus.hpp>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 struct Data
@@ -29,3 +34,298 @@ TEST_CASE("Bind an event handler", "[core]")
 
 	event_bus.enable(handler);
 }
+
+struct Other
+{
+	float f = 0.0f;
+};
+
+class MultiHandler : public remus::EventHandler<Data, Other>
+{
+  public:
+	void handle(Data event) override
+	{
+		i = event.i;
+	}
+
+	void handle(Other event) override
+	{
+		f = event.f;
+	}
+
+	int   i = 0;
+	float f = 0.0f;
+};
+
+TEST_CASE("Publish events", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Handler      handler;
+	MultiHandler multi_handler;
+
+	// nothing is bound yet
+	event_bus.publish(Data{1});
+	REQUIRE(handler.i == 0);
+
+	event_bus.enable(handler);
+	event_bus.enable(multi_handler);
+
+	event_bus.publish(Data{2});
+	REQUIRE(handler.i == 2);
+	REQUIRE(multi_handler.i == 2);
+
+	event_bus.publish(Other{3.0f});
+	REQUIRE(handler.i == 2);
+	REQUIRE(multi_handler.f == 3.0f);
+
+	// enabling twice does not call the handler twice
+	event_bus.enable(handler);
+	event_bus.unbind<Data>(&handler);
+	event_bus.publish(Data{4});
+	REQUIRE(handler.i == 2);
+	REQUIRE(multi_handler.i == 4);
+}
+
+TEST_CASE("Destroyed handlers are unbound", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Handler handler;
+	event_bus.enable(handler);
+
+	{
+		MultiHandler multi_handler;
+		event_bus.enable(multi_handler);
+	}
+
+	event_bus.publish(Data{1});
+	event_bus.publish(Other{1.0f});
+	REQUIRE(handler.i == 1);
+}
+
+TEST_CASE("Event types have distinct ids", "[core]")
+{
+	REQUIRE(remus::EventType<Data>::id != remus::EventType<Other>::id);
+	REQUIRE(remus::EventType<Data>::id == remus::EventType<Data>::id);
+}
+
+namespace
+{
+// records every event in the order received
+class Recorder : public remus::EventHandler<Data, Other>
+{
+  public:
+	void handle(Data event) override
+	{
+		data.push_back(event.i);
+	}
+
+	void handle(Other event) override
+	{
+		other.push_back(event.f);
+	}
+
+	std::vector<int>   data;
+	std::vector<float> other;
+};
+}        // namespace
+
+TEST_CASE("Queued events are published at the sync point", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Recorder recorder;
+	event_bus.enable(recorder);
+
+	event_bus.enqueue(Data{0});
+	event_bus.enqueue(Other{1.0f});
+	event_bus.enqueue(Data{2});
+	REQUIRE(recorder.data.empty());
+
+	event_bus.dispatch_queued();
+	REQUIRE(recorder.data == std::vector<int>{0, 2});
+	REQUIRE(recorder.other == std::vector<float>{1.0f});
+
+	// the queues are empty
+	event_bus.dispatch_queued();
+	REQUIRE(recorder.data.size() == 2);
+}
+
+TEST_CASE("Queue events from several threads and publish them in parallel", "[core]")
+{
+	remus::EventBus   event_bus;
+	remus::ThreadPool thread_pool(3);
+
+	// one recorder per type, so that each is only called from one thread at a time
+	Recorder data_recorder;
+	Recorder other_recorder;
+	event_bus.bind<Data>(&data_recorder);
+	event_bus.bind<Other>(&other_recorder);
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < 4; ++p)
+	{
+		producers.emplace_back([&event_bus, p]() {
+			for (int i = 0; i < 1000; ++i)
+			{
+				event_bus.enqueue(Data{p * 1000 + i});
+				event_bus.enqueue(Other{static_cast<float>(i)});
+			}
+		});
+	}
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+
+	event_bus.dispatch_queued(&thread_pool);
+	REQUIRE(data_recorder.data.size() == 4000);
+	REQUIRE(other_recorder.other.size() == 4000);
+	REQUIRE(data_recorder.other.empty());
+	REQUIRE(other_recorder.data.empty());
+}
+
+namespace
+{
+// binds another handler and publishes a follow up event from inside handle()
+class Chaining : public remus::EventHandler<Data>
+{
+  public:
+	Chaining(remus::EventBus &event_bus, Recorder &recorder) :
+	    event_bus(event_bus),
+	    recorder(recorder)
+	{}
+
+	void handle(Data event) override
+	{
+		event_bus.bind<Other>(&recorder);
+		event_bus.publish(Other{static_cast<float>(event.i)});
+	}
+
+	remus::EventBus &event_bus;
+	Recorder        &recorder;
+};
+}        // namespace
+
+TEST_CASE("Handlers can bind and publish from inside a publish", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Recorder recorder;
+	Chaining chaining(event_bus, recorder);
+	event_bus.enable(chaining);
+
+	event_bus.publish(Data{5});
+	REQUIRE(recorder.other == std::vector<float>{5.0f});
+}
+
+namespace
+{
+class Transient : public MultiHandler
+{
+  public:
+	~Transient()
+	{
+		disable_and_wait();
+	}
+};
+}        // namespace
+
+TEST_CASE("Handlers are destroyed while another thread publishes", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Recorder recorder;
+	event_bus.enable(recorder);
+
+	std::atomic<bool> done{false};
+	std::thread       publisher([&]() {
+		for (int i = 0; i < 10000; ++i)
+		{
+			event_bus.publish(Data{i});
+		}
+		done = true;
+	});
+
+	// a destroyed handler is never called
+	while (!done)
+	{
+		Transient transient;
+		event_bus.enable(transient);
+	}
+	publisher.join();
+
+	REQUIRE(recorder.data.size() == 10000);
+}
+
+namespace
+{
+// destroys a handler of another type from inside handle()
+class Dropping : public remus::EventHandler<Other>
+{
+  public:
+	void handle(Other event) override
+	{
+		dropped.reset();
+	}
+
+	std::unique_ptr<Handler> dropped{std::make_unique<Handler>()};
+};
+}        // namespace
+
+TEST_CASE("Handlers can be destroyed from inside a publish", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Dropping dropping;
+	event_bus.enable(dropping);
+	event_bus.enable(*dropping.dropped);
+
+	SECTION("publish")
+	{
+		event_bus.publish(Other{1.0f});
+	}
+
+	SECTION("sync point")
+	{
+		event_bus.enqueue(Other{1.0f});
+		event_bus.dispatch_queued();
+	}
+
+	REQUIRE_FALSE(dropping.dropped);
+	event_bus.publish(Data{1});
+}
+
+#if !defined(NDEBUG)
+namespace
+{
+// waits for the publishes on its own bus from inside one, which would never return
+class Waiting : public remus::EventHandler<Data>
+{
+  public:
+	explicit Waiting(remus::EventBus &event_bus) :
+	    event_bus(event_bus)
+	{}
+
+	void handle(Data event) override
+	{
+		REQUIRE_THROWS(event_bus.synchronize());
+	}
+
+	remus::EventBus &event_bus;
+};
+}        // namespace
+
+TEST_CASE("Debug builds catch a publish waiting for itself", "[core]")
+{
+	remus::EventBus event_bus;
+
+	Waiting waiting(event_bus);
+	event_bus.enable(waiting);
+	event_bus.publish(Data{1});
+
+	// outside of a publish it returns
+	event_bus.synchronize();
+}
+#endif
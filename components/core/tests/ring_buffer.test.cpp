@@ -0,0 +1,246 @@
+#include <events/channel.hpp>
+#include <events/ring_buffer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Ring buffer is first in first out", "[core]")
+{
+	remus::RingBuffer<int> ring(4, false);
+	REQUIRE(ring.capacity() == 4);
+
+	// wrap around a few times
+	for (int lap = 0; lap < 3; ++lap)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			REQUIRE(ring.try_emplace(lap * 4 + i));
+		}
+		REQUIRE(ring.try_emplace(-1) == false);        // full
+		REQUIRE(ring.size() == 4);
+
+		int value;
+		for (int i = 0; i < 4; ++i)
+		{
+			REQUIRE(ring.try_pop(&value));
+			REQUIRE(value == lap * 4 + i);
+		}
+		REQUIRE(ring.try_pop(&value) == false);        // empty
+	}
+}
+
+TEST_CASE("Ring buffer capacity is rounded up to a power of two", "[core]")
+{
+	remus::RingBuffer<int> ring(5, true);
+	REQUIRE(ring.capacity() == 8);
+}
+
+TEST_CASE("Ring buffer destroys the events it still holds", "[core]")
+{
+	auto event = std::make_shared<int>(0);
+	{
+		remus::RingBuffer<std::shared_ptr<int>> ring(4, false);
+		ring.try_emplace(event);
+		ring.try_emplace(event);
+		REQUIRE(event.use_count() == 3);
+	}
+	REQUIRE(event.use_count() == 1);
+}
+
+TEST_CASE("Ring buffer overflow policies", "[core]")
+{
+	remus::RingBuffer<int> ring(2, false);
+	ring.try_emplace(0);
+	ring.try_emplace(1);
+
+	int value;
+
+	SECTION("Drop oldest")
+	{
+		REQUIRE(ring.push(remus::OverflowPolicy::DropOldest, 2) == 1);
+		REQUIRE(ring.try_pop(&value));
+		REQUIRE(value == 1);
+		REQUIRE(ring.try_pop(&value));
+		REQUIRE(value == 2);
+	}
+
+	SECTION("Drop newest")
+	{
+		REQUIRE(ring.push(remus::OverflowPolicy::DropNewest, 2) == 1);
+		REQUIRE(ring.try_pop(&value));
+		REQUIRE(value == 0);
+		REQUIRE(ring.try_pop(&value));
+		REQUIRE(value == 1);
+	}
+
+	REQUIRE(ring.try_pop(&value) == false);
+}
+
+TEST_CASE("Bounded receivers drop events when full", "[core]")
+{
+	remus::Channel<int> channel;
+
+	remus::ReceiverOptions options;
+	options.mode     = remus::ReceiverMode::SPSC;
+	options.capacity = 4;
+
+	options.overflow = remus::OverflowPolicy::DropOldest;
+	auto oldest      = channel.receiver(options);
+	options.overflow = remus::OverflowPolicy::DropNewest;
+	auto newest      = channel.receiver(options);
+	auto unbounded   = channel.receiver();
+
+	auto sender = channel.sender();
+	for (int i = 0; i < 10; ++i)
+	{
+		sender->send(i);
+	}
+
+	REQUIRE(oldest->dropped() == 6);
+	REQUIRE(newest->dropped() == 6);
+	REQUIRE(unbounded->dropped() == 0);
+
+	int received;
+	REQUIRE(oldest->next(&received));
+	REQUIRE(received == 6);
+	REQUIRE(oldest->drain(&received));
+	REQUIRE(received == 9);
+	REQUIRE(oldest->next(&received) == false);
+
+	REQUIRE(newest->next(&received));
+	REQUIRE(received == 0);
+	REQUIRE(newest->drain(&received));
+	REQUIRE(received == 3);
+
+	REQUIRE(unbounded->drain(&received));
+	REQUIRE(received == 9);
+}
+
+TEST_CASE("Blocking receivers see every event from multiple producers", "[core]")
+{
+	constexpr int producer_count = 4;
+	constexpr int event_count    = 10000;
+
+	remus::Channel<int> channel;
+
+	remus::ReceiverOptions options;
+	options.mode     = remus::ReceiverMode::MPSC;
+	options.capacity = 64;
+	options.overflow = remus::OverflowPolicy::Block;
+	auto receiver    = channel.receiver(options);
+
+	std::vector<remus::Sender<int> *> senders;
+	for (int p = 0; p < producer_count; ++p)
+	{
+		senders.push_back(channel.sender());
+	}
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < producer_count; ++p)
+	{
+		producers.emplace_back([sender = senders[p], p]() {
+			for (int i = 0; i < event_count; ++i)
+			{
+				sender->send(p * event_count + i);
+			}
+		});
+	}
+
+	// events from each producer arrive in the order they were sent
+	std::vector<int> last(producer_count, -1);
+
+	int received = 0;
+	int event;
+	while (received < producer_count * event_count)
+	{
+		if (!receiver->next(&event))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		auto producer = event / event_count;
+		REQUIRE(event % event_count > last[producer]);
+		last[producer] = event % event_count;
+		received++;
+	}
+
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+
+	REQUIRE(receiver->next(&event) == false);
+	REQUIRE(receiver->dropped() == 0);
+}
+
+TEST_CASE("Ring buffer size stays within capacity while popping", "[core]")
+{
+	constexpr int event_count = 100000;
+
+	remus::RingBuffer<int> ring(8, false);
+
+	std::atomic<bool> producing{true};
+	std::thread       producer([&]() {
+		for (int i = 0; i < event_count; ++i)
+		{
+			ring.push(remus::OverflowPolicy::Block, i);
+		}
+		producing = false;
+	});
+	std::thread consumer([&]() {
+		while (producing || !ring.empty())
+		{
+			ring.try_pop(nullptr);
+		}
+	});
+
+	// read from a third thread, both ends move while the size is taken
+	size_t largest = 0;
+	while (producing)
+	{
+		largest = std::max(largest, ring.size());
+	}
+	REQUIRE(largest <= ring.capacity());
+
+	producer.join();
+	consumer.join();
+}
+
+TEST_CASE("Ring buffer counts every event dropped by several producers", "[core]")
+{
+	constexpr int producer_count = 4;
+	constexpr int event_count    = 10000;
+
+	remus::RingBuffer<int> ring(4, true);
+
+	std::atomic<size_t>      dropped{0};
+	std::vector<std::thread> producers;
+	for (int p = 0; p < producer_count; ++p)
+	{
+		producers.emplace_back([&]() {
+			for (int i = 0; i < event_count; ++i)
+			{
+				dropped += ring.push(remus::OverflowPolicy::DropOldest, i);
+			}
+		});
+	}
+
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+
+	// every event sent was either dropped or is still queued
+	size_t queued = 0;
+	while (ring.try_pop(nullptr))
+	{
+		queued++;
+	}
+	REQUIRE(queued + dropped == producer_count * event_count);
+}
@@ -0,0 +1,95 @@
+#include <core/thread_pool.hpp>
+
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Run a task", "[core]")
+{
+	remus::ThreadPool thread_pool(2);
+
+	std::atomic<bool> ran{false};
+	std::atomic<bool> done{false};
+
+	thread_pool.submit([&]() {
+		ran  = true;
+		done = true;
+	});
+
+	while (!done)
+	{
+		std::this_thread::yield();
+	}
+
+	REQUIRE(ran);
+}
+
+TEST_CASE("Parallel for visits every index once", "[core]")
+{
+	remus::ThreadPool thread_pool(3);
+
+	std::vector<std::atomic<int>> visits(10000);
+
+	thread_pool.parallel_for(visits.size(), 64, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			visits[i]++;
+		}
+	});
+
+	for (auto &visit : visits)
+	{
+		REQUIRE(visit == 1);
+	}
+}
+
+TEST_CASE("Parallel for without workers", "[core]")
+{
+	remus::ThreadPool thread_pool(0);
+
+	size_t sum = 0;
+	thread_pool.parallel_for(100, 8, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			sum += i;
+		}
+	});
+
+	REQUIRE(sum == 4950);
+}
+
+TEST_CASE("Parallel for rethrows the first exception once every chunk is done", "[core]")
+{
+	remus::ThreadPool thread_pool(3);
+
+	std::atomic<size_t> running{0};
+
+	auto throwing = [&](size_t begin, size_t end) {
+		running++;
+		std::this_thread::yield();
+		running--;
+
+		if (begin == 64)
+		{
+			throw std::runtime_error("chunk failed");
+		}
+	};
+
+	REQUIRE_THROWS_AS(thread_pool.parallel_for(10000, 64, throwing), std::runtime_error);
+
+	// no chunk is still running once the exception reaches the caller
+	REQUIRE(running == 0);
+
+	// the workers survived
+	std::vector<std::atomic<int>> visits(1000);
+	thread_pool.parallel_for(visits.size(), 8, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			visits[i]++;
+		}
+	});
+	for (auto &visit : visits)
+	{
+		REQUIRE(visit == 1);
+	}
+}
@@ -0,0 +1,110 @@
+#include <events/channel.hpp>
+#include <events/event_bus.hpp>
+#include <events/tracing.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Latency histogram buckets", "[core]")
+{
+	remus::LatencyHistogram histogram;
+	REQUIRE(histogram.percentile(0.5) == 0);
+
+	histogram.record(0);           // bucket 0
+	histogram.record(3);           // bucket 1, [2, 4)
+	histogram.record(100);         // bucket 6, [64, 128)
+	histogram.record(1000);        // bucket 9, [512, 1024)
+	REQUIRE(histogram.count() == 4);
+	REQUIRE(histogram.buckets[0] == 1);
+	REQUIRE(histogram.buckets[1] == 1);
+	REQUIRE(histogram.buckets[6] == 1);
+	REQUIRE(histogram.buckets[9] == 1);
+
+	REQUIRE(histogram.percentile(0.5) == 128);
+	REQUIRE(histogram.percentile(1.0) == 1024);
+
+	remus::LatencyHistogram other;
+	other.record(100);
+	histogram.merge(other);
+	REQUIRE(histogram.buckets[6] == 2);
+}
+
+TEST_CASE("Channel stats", "[core]")
+{
+	remus::Channel<int> channel;
+
+	remus::ReceiverOptions bounded;
+	bounded.mode     = remus::ReceiverMode::SPSC;
+	bounded.capacity = 4;
+
+	auto unbounded = channel.receiver();
+	auto ring      = channel.receiver(bounded);
+	auto sender    = channel.sender();
+
+	for (int i = 0; i < 6; ++i)
+	{
+		sender->send(i);
+	}
+	unbounded->next(nullptr);
+	ring->drain(nullptr);
+
+	auto stats = channel.stats();
+	REQUIRE(stats.dropped == 2);
+
+#if defined(REMUS_EVENT_TRACING)
+	REQUIRE(stats.sent == 6);
+	REQUIRE(stats.received == 5);
+	REQUIRE(stats.high_water == 6);
+	REQUIRE(stats.latency.count() == 5);
+
+	auto ring_stats = ring->stats();
+	REQUIRE(ring_stats.received == 4);
+	REQUIRE(ring_stats.high_water == 4);
+#else
+	REQUIRE(stats.sent == 0);
+	REQUIRE(stats.received == 0);
+	REQUIRE(stats.latency.count() == 0);
+#endif
+}
+
+namespace
+{
+struct Tick
+{
+	int frame;
+};
+
+class TickHandler : public remus::EventHandler<Tick>
+{
+  public:
+	void handle(Tick event) override
+	{
+		frame = event.frame;
+	}
+
+	int frame = 0;
+};
+}        // namespace
+
+TEST_CASE("Event handler stats", "[core]")
+{
+	remus::EventBus event_bus;
+
+	TickHandler handler;
+	event_bus.enable(handler);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		event_bus.publish(Tick{i});
+	}
+
+	auto stats = event_bus.handler_stats();
+
+#if defined(REMUS_EVENT_TRACING)
+	REQUIRE(stats.size() == 1);
+	REQUIRE(stats[0].handler == static_cast<remus::TypedEventHandler<Tick> *>(&handler));
+	REQUIRE(stats[0].calls == 3);
+	REQUIRE(stats[0].max_ns <= stats[0].total_ns);
+#else
+	REQUIRE(stats.empty());
+#endif
+}
@@ -0,0 +1,422 @@
+#include <loaders/models/gltf_loader.hpp>
+
+#include <scene_graph/scene_graph.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <stb_image_write.h>
+#include <tiny_gltf.h>
+
+#if defined(__linux__)
+#	include <sys/resource.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+constexpr uint32_t mesh_count   = 4;
+constexpr uint32_t vertex_count = 1 << 20;
+
+void append_u32(std::ofstream &file, uint32_t value)
+{
+	file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// a .glb of mesh_count meshes, each with vertex_count positions and indices, 64MB in all
+std::filesystem::path write_glb()
+{
+	constexpr uint64_t mesh_size = uint64_t{vertex_count} * (sizeof(float) * 3 + sizeof(uint32_t));
+
+	std::string json = R"({"asset": {"version": "2.0"}, "scenes": [{"nodes": [)";
+	std::string nodes, meshes, accessors, views;
+	for (uint32_t i = 0; i < mesh_count; ++i)
+	{
+		auto index       = std::to_string(i);
+		auto positions   = std::to_string(i * 2);
+		auto indices     = std::to_string(i * 2 + 1);
+		auto offset      = std::to_string(i * mesh_size);
+		auto index_start = std::to_string(i * mesh_size + uint64_t{vertex_count} * sizeof(float) * 3);
+		auto separator   = i == 0 ? "" : ", ";
+
+		json += separator + index;
+		nodes += separator + std::string(R"({"mesh": )") + index + "}";
+		meshes += separator + std::string(R"({"primitives": [{"attributes": {"POSITION": )") + positions + R"(}, "indices": )" + indices + "}]}";
+		accessors += separator + std::string(R"({"bufferView": )") + positions + R"(, "componentType": 5126, "count": )" + std::to_string(vertex_count) +
+		             R"(, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 1]}, {"bufferView": )" + indices + R"(, "componentType": 5125, "count": )" +
+		             std::to_string(vertex_count) + R"(, "type": "SCALAR"})";
+		views += separator + std::string(R"({"buffer": 0, "byteOffset": )") + offset + R"(, "byteLength": )" + std::to_string(uint64_t{vertex_count} * sizeof(float) * 3) +
+		         R"(}, {"buffer": 0, "byteOffset": )" + index_start + R"(, "byteLength": )" + std::to_string(uint64_t{vertex_count} * sizeof(uint32_t)) + "}";
+	}
+	json += "]}], \"nodes\": [" + nodes + "], \"meshes\": [" + meshes + "], \"accessors\": [" + accessors + "], \"bufferViews\": [" + views +
+	        "], \"buffers\": [{\"byteLength\": " + std::to_string(mesh_count * mesh_size) + "}]}";
+	json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+	auto          path = std::filesystem::temp_directory_path() / "remus_benchmark.glb";
+	std::ofstream file(path, std::ios::binary);
+	append_u32(file, 0x46546C67);
+	append_u32(file, 2);
+	append_u32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + mesh_count * mesh_size));
+	append_u32(file, static_cast<uint32_t>(json.size()));
+	append_u32(file, 0x4E4F534A);
+	file.write(json.data(), json.size());
+	append_u32(file, static_cast<uint32_t>(mesh_count * mesh_size));
+	append_u32(file, 0x004E4942);
+
+	std::vector<float> positions(vertex_count * 3);
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		positions[i] = static_cast<float>(i % 3);
+	}
+	std::vector<uint32_t> indices(vertex_count);
+	for (uint32_t i = 0; i < vertex_count; ++i)
+	{
+		indices[i] = i;
+	}
+	for (uint32_t i = 0; i < mesh_count; ++i)
+	{
+		file.write(reinterpret_cast<const char *>(positions.data()), positions.size() * sizeof(float));
+		file.write(reinterpret_cast<const char *>(indices.data()), indices.size() * sizeof(uint32_t));
+	}
+	return path;
+}
+
+// the loader before mapping, tinygltf reads the whole file and copies the binary chunk, then every accessor is copied again
+size_t load_with_tinygltf(const std::string &path)
+{
+	tinygltf::Model    model;
+	tinygltf::TinyGLTF loader;
+	std::string        error;
+	std::string        warning;
+	loader.LoadBinaryFromFile(&model, &error, &warning, path);
+
+	std::vector<std::vector<uint8_t>> copies;
+	for (auto &accessor : model.accessors)
+	{
+		auto  &view   = model.bufferViews[accessor.bufferView];
+		auto  &buffer = model.buffers[view.buffer];
+		size_t offset = accessor.byteOffset + view.byteOffset;
+		copies.emplace_back(buffer.data.begin() + offset, buffer.data.begin() + offset + view.byteLength);
+	}
+	return copies.size();
+}
+
+// how far load raises the peak resident memory in MB, run in a child process so each load starts from the same peak, 0 where it is not known
+template <typename Load>
+long peak_resident_mb(Load &&load)
+{
+	long peak = 0;
+#if defined(__linux__)
+	int pipe_ends[2];
+	if (pipe(pipe_ends) != 0)
+	{
+		return 0;
+	}
+
+	if (fork() == 0)
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		long before = usage.ru_maxrss;
+
+		load();
+
+		getrusage(RUSAGE_SELF, &usage);
+		long grown = (usage.ru_maxrss - before) / 1024;
+		write(pipe_ends[1], &grown, sizeof(grown));
+		_exit(0);
+	}
+
+	read(pipe_ends[0], &peak, sizeof(peak));
+	wait(nullptr);
+	close(pipe_ends[0]);
+	close(pipe_ends[1]);
+#endif
+	return peak;
+}
+constexpr uint32_t textured_mesh_count   = 96;
+constexpr uint32_t textured_vertex_count = 1 << 12;
+constexpr uint32_t texture_count         = 32;
+constexpr uint32_t texture_size          = 512;
+
+// a .glb the size of Sponza, textured_mesh_count meshes each with a material sampling one of texture_count PNGs
+std::filesystem::path write_textured_glb()
+{
+	// noisy textures so the PNGs do not compress to nothing
+	std::vector<std::vector<uint8_t>> pngs(texture_count);
+	std::vector<uint8_t>              pixels(texture_size * texture_size * 4);
+	for (uint32_t t = 0; t < texture_count; ++t)
+	{
+		uint32_t state = t * 2654435761u + 1;
+		for (auto &pixel : pixels)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			pixel = static_cast<uint8_t>(state & 0x3F);
+		}
+
+		stbi_write_png_to_func([](void *context, void *data, int size) {
+			auto *png = static_cast<std::vector<uint8_t> *>(context);
+			png->insert(png->end(), static_cast<uint8_t *>(data), static_cast<uint8_t *>(data) + size);
+		},
+		                       &pngs[t], texture_size, texture_size, 4, pixels.data(), texture_size * 4);
+		pngs[t].resize((pngs[t].size() + 3) & ~size_t{3}, 0);
+	}
+
+	constexpr uint64_t positions_size = uint64_t{textured_vertex_count} * sizeof(float) * 3;
+	constexpr uint64_t indices_size   = uint64_t{textured_vertex_count} * sizeof(uint32_t);
+
+	std::vector<uint8_t> bin;
+	std::string          nodes, meshes, materials, textures, images, accessors, views;
+
+	std::vector<float> positions(textured_vertex_count * 3);
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		positions[i] = static_cast<float>(i % 3);
+	}
+	std::vector<uint32_t> indices(textured_vertex_count);
+	for (uint32_t i = 0; i < textured_vertex_count; ++i)
+	{
+		indices[i] = i;
+	}
+
+	auto add_view = [&](const void *data, uint64_t size) {
+		auto separator = views.empty() ? "" : ", ";
+		views += separator + std::string(R"({"buffer": 0, "byteOffset": )") + std::to_string(bin.size()) + R"(, "byteLength": )" + std::to_string(size) + "}";
+		bin.insert(bin.end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+	};
+
+	uint32_t view_index = 0;
+	for (uint32_t i = 0; i < textured_mesh_count; ++i)
+	{
+		auto index     = std::to_string(i);
+		auto positions_index = std::to_string(i * 2);
+		auto indices_index   = std::to_string(i * 2 + 1);
+		auto separator = i == 0 ? "" : ", ";
+
+		add_view(positions.data(), positions_size);
+		add_view(indices.data(), indices_size);
+
+		nodes += separator + std::string(R"({"mesh": )") + index + "}";
+		meshes += separator + std::string(R"({"primitives": [{"attributes": {"POSITION": )") + positions_index + R"(}, "indices": )" + indices_index +
+		          R"(, "material": )" + index + "}]}";
+		materials += separator + std::string(R"({"pbrMetallicRoughness": {"baseColorTexture": {"index": )") + std::to_string(i % texture_count) + "}}}";
+		accessors += separator + std::string(R"({"bufferView": )") + std::to_string(view_index) + R"(, "componentType": 5126, "count": )" +
+		             std::to_string(textured_vertex_count) + R"(, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 1]}, {"bufferView": )" +
+		             std::to_string(view_index + 1) + R"(, "componentType": 5125, "count": )" + std::to_string(textured_vertex_count) + R"(, "type": "SCALAR"})";
+		view_index += 2;
+	}
+
+	for (uint32_t t = 0; t < texture_count; ++t)
+	{
+		auto separator = t == 0 ? "" : ", ";
+		textures += separator + std::string(R"({"source": )") + std::to_string(t) + "}";
+		images += separator + std::string(R"({"bufferView": )") + std::to_string(view_index++) + R"(, "mimeType": "image/png"})";
+		add_view(pngs[t].data(), pngs[t].size());
+	}
+
+	std::string json = R"({"asset": {"version": "2.0"}, "scenes": [{"nodes": [)";
+	for (uint32_t i = 0; i < textured_mesh_count; ++i)
+	{
+		json += (i == 0 ? "" : ", ") + std::to_string(i);
+	}
+	json += "]}], \"nodes\": [" + nodes + "], \"meshes\": [" + meshes + "], \"materials\": [" + materials + "], \"textures\": [" + textures +
+	        "], \"images\": [" + images + "], \"accessors\": [" + accessors + "], \"bufferViews\": [" + views + "], \"buffers\": [{\"byteLength\": " +
+	        std::to_string(bin.size()) + "}]}";
+	json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+	auto          path = std::filesystem::temp_directory_path() / "remus_benchmark_textured.glb";
+	std::ofstream file(path, std::ios::binary);
+	append_u32(file, 0x46546C67);
+	append_u32(file, 2);
+	append_u32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+	append_u32(file, static_cast<uint32_t>(json.size()));
+	append_u32(file, 0x4E4F534A);
+	file.write(json.data(), json.size());
+	append_u32(file, static_cast<uint32_t>(bin.size()));
+	append_u32(file, 0x004E4942);
+	file.write(reinterpret_cast<const char *>(bin.data()), bin.size());
+	return path;
+}
+constexpr uint32_t instance_count = 10000;
+
+// a .glb of one mesh of vertex_count vertices with a normal and texture coordinates, instanced by instance_count nodes
+std::filesystem::path write_instanced_glb()
+{
+	constexpr uint64_t positions_size = uint64_t{vertex_count} * sizeof(float) * 3;
+	constexpr uint64_t texcoords_size = uint64_t{vertex_count} * sizeof(float) * 2;
+	constexpr uint64_t indices_size   = uint64_t{vertex_count} * sizeof(uint32_t);
+	constexpr uint64_t buffer_size    = positions_size * 2 + texcoords_size + indices_size;
+
+	std::string json = R"({"asset": {"version": "2.0"}, "scenes": [{"nodes": [)";
+	std::string nodes;
+	for (uint32_t i = 0; i < instance_count; ++i)
+	{
+		auto separator = i == 0 ? "" : ", ";
+		json += separator + std::to_string(i);
+		nodes += separator + std::string(R"({"mesh": 0, "translation": [)") + std::to_string(i) + ", 0, 0]}";
+	}
+
+	auto count = std::to_string(vertex_count);
+	json += "]}], \"nodes\": [" + nodes + R"(],
+		"meshes": [{"primitives": [{"attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2}, "indices": 3, "material": 0}]}],
+		"materials": [{"pbrMetallicRoughness": {"baseColorFactor": [1, 0, 0, 1]}}],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": )" +
+	        count + R"(, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 1]},
+			{"bufferView": 1, "componentType": 5126, "count": )" +
+	        count + R"(, "type": "VEC3"},
+			{"bufferView": 2, "componentType": 5126, "count": )" +
+	        count + R"(, "type": "VEC2"},
+			{"bufferView": 3, "componentType": 5125, "count": )" +
+	        count + R"(, "type": "SCALAR"}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": )" +
+	        std::to_string(positions_size) + R"(},
+			{"buffer": 0, "byteOffset": )" +
+	        std::to_string(positions_size) + R"(, "byteLength": )" + std::to_string(positions_size) + R"(},
+			{"buffer": 0, "byteOffset": )" +
+	        std::to_string(positions_size * 2) + R"(, "byteLength": )" + std::to_string(texcoords_size) + R"(},
+			{"buffer": 0, "byteOffset": )" +
+	        std::to_string(positions_size * 2 + texcoords_size) + R"(, "byteLength": )" + std::to_string(indices_size) + R"(}],
+		"buffers": [{"byteLength": )" +
+	        std::to_string(buffer_size) + "}]}";
+	json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+	auto          path = std::filesystem::temp_directory_path() / "remus_benchmark_instanced.glb";
+	std::ofstream file(path, std::ios::binary);
+	append_u32(file, 0x46546C67);
+	append_u32(file, 2);
+	append_u32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + buffer_size));
+	append_u32(file, static_cast<uint32_t>(json.size()));
+	append_u32(file, 0x4E4F534A);
+	file.write(json.data(), json.size());
+	append_u32(file, static_cast<uint32_t>(buffer_size));
+	append_u32(file, 0x004E4942);
+
+	std::vector<uint8_t> data(buffer_size);
+	file.write(reinterpret_cast<const char *>(data.data()), data.size());
+	return path;
+}
+}        // namespace
+
+TEST_CASE("Load a binary glTF file", "[loaders][benchmark]")
+{
+	auto path = write_glb().string();
+
+	std::printf("64MB .glb, tinygltf reads the file: peak resident memory grows by %ld MB\n", peak_resident_mb([&]() { load_with_tinygltf(path); }));
+	std::printf("64MB .glb, GLtfLoader maps the file: peak resident memory grows by %ld MB\n", peak_resident_mb([&]() {
+		            remus::SceneGraph scene_graph;
+		            remus::GLtfLoader{}.load(path, scene_graph);
+	            }));
+
+	BENCHMARK("64MB .glb, tinygltf reads the file")
+	{
+		return load_with_tinygltf(path);
+	};
+
+	BENCHMARK("64MB .glb, GLtfLoader maps the file")
+	{
+		remus::SceneGraph scene_graph;
+		return remus::GLtfLoader{}.load(path, scene_graph).is_valid();
+	};
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file on a thread pool", "[loaders][benchmark]")
+{
+	auto path = write_textured_glb().string();
+
+	// the calling thread works alongside the pool, so n threads is a pool of n - 1 workers
+	for (size_t thread_count : {1, 2, 4, 8})
+	{
+		remus::GLtfLoader gltf_loader;
+		if (thread_count > 1)
+		{
+			gltf_loader.set_thread_pool(std::make_shared<remus::ThreadPool>(thread_count - 1));
+		}
+
+		BENCHMARK("96 meshes, 32 512x512 PNGs, " + std::to_string(thread_count) + " threads")
+		{
+			remus::SceneGraph scene_graph;
+			return gltf_loader.load(path, scene_graph).is_valid();
+		};
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file instancing one mesh", "[loaders][benchmark]")
+{
+	auto path = write_instanced_glb().string();
+
+	// every node shares the mesh and material, so memory grows with the node count rather than the vertex count
+	std::printf("10000 instances of a 36MB mesh: peak resident memory grows by %ld MB\n", peak_resident_mb([&]() {
+		            remus::SceneGraph scene_graph;
+		            remus::GLtfLoader{}.load(path, scene_graph);
+	            }));
+
+	BENCHMARK("10000 instances of a 36MB mesh")
+	{
+		remus::SceneGraph scene_graph;
+		return remus::GLtfLoader{}.load(path, scene_graph).is_valid();
+	};
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file asynchronously", "[loaders][benchmark]")
+{
+	using clock = std::chrono::steady_clock;
+
+	auto path = write_instanced_glb().string();
+
+	remus::GLtfLoader gltf_loader;
+
+	// the main loop stalls for the whole load
+	{
+		remus::SceneGraph scene_graph;
+
+		auto start = clock::now();
+		gltf_loader.load(path, scene_graph);
+		std::printf("10000 nodes, load blocks the frame for %.2f ms\n", std::chrono::duration<double, std::milli>(clock::now() - start).count());
+	}
+
+	// a frame only ever spends its budget on the commit
+	{
+		remus::SceneGraph scene_graph;
+
+		auto   load          = gltf_loader.load_async(path);
+		size_t frame_count   = 0;
+		double longest_frame = 0.0;
+		while (true)
+		{
+			auto start    = clock::now();
+			bool finished = load.commit(scene_graph, std::chrono::milliseconds(2));
+			longest_frame = std::max(longest_frame, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+			frame_count++;
+
+			if (finished)
+			{
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		std::printf("10000 nodes, load_async with a 2 ms budget takes %zu frames, the longest spends %.2f ms\n", frame_count, longest_frame);
+	}
+
+	std::filesystem::remove(path);
+}
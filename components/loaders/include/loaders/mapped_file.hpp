@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace remus
+{
+/* A read-only file mapped into memory.
+ * Pages are read on first access and can be dropped again by the OS, so a large file costs little resident memory
+ * and the data can be used in place instead of being copied into a buffer.
+ */
+class MappedFile
+{
+  public:
+	MappedFile() = default;
+
+	// is_open() is false if the file could not be mapped
+	explicit MappedFile(const std::string &path);
+
+	~MappedFile();
+
+	MappedFile(MappedFile &&other) noexcept;
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	MappedFile(const MappedFile &)            = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool is_open() const
+	{
+		return open;
+	}
+
+	const uint8_t *data() const
+	{
+		return bytes;
+	}
+
+	size_t size() const
+	{
+		return length;
+	}
+
+  private:
+	void close();
+
+	const uint8_t *bytes{nullptr};
+	size_t         length{0};
+	bool           open{false};
+
+#if defined(_WIN32)
+	void *file{nullptr};
+	void *mapping{nullptr};
+#endif
+};
+}        // namespace remus
@@ -1,12 +1,117 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <core/thread_pool.hpp>
+#include <events/channel.hpp>
 #include <scene_graph/scene_graph.hpp>
 
 namespace remus
 {
+enum class GltfLoadStage
+{
+	Parsing,
+	DecodingImages,
+	BuildingMaterials,
+	BuildingMeshes,
+	Ready,        // built in the background, waiting to be committed
+	Committing,
+	Done,
+	Failed
+};
+
+inline std::string to_string(GltfLoadStage stage)
+{
+#define CASE(x)            \
+	case GltfLoadStage::x: \
+		return #x;
+
+	switch (stage)
+	{
+		CASE(Parsing)
+		CASE(DecodingImages)
+		CASE(BuildingMaterials)
+		CASE(BuildingMeshes)
+		CASE(Ready)
+		CASE(Committing)
+		CASE(Done)
+		CASE(Failed)
+		default:
+			return "Unknown";
+	}
+
+#undef CASE
+}
+
+// the progress of an asynchronous load, completed of the total items of the stage are done
+struct GltfLoadEvent
+{
+	std::string   path;
+	GltfLoadStage stage{GltfLoadStage::Parsing};
+	size_t        completed{0};
+	size_t        total{0};
+};
+
+/* A glTF file loading on a background thread.
+ * The file is parsed and its images, materials and meshes built in the background,
+ * commit() then adds the nodes to a scene graph a few at a time so that no frame waits on the whole file.
+ * Destroying the load waits for the background work to finish.
+ */
+class GltfLoad
+{
+  public:
+	GltfLoad();
+	~GltfLoad();
+
+	GltfLoad(const GltfLoad &)            = delete;
+	GltfLoad &operator=(const GltfLoad &) = delete;
+
+	GltfLoad(GltfLoad &&other) noexcept;
+	GltfLoad &operator=(GltfLoad &&other) noexcept;
+
+	// the background work is done, commit() will start adding nodes
+	bool ready() const;
+
+	// block until the background work is done
+	void wait() const;
+
+	// the file could not be loaded
+	bool failed() const;
+
+	/*
+	 * Add nodes to the scene graph until the budget is spent, at least one node is added per call.
+	 * Returns true once everything is added or the load failed, every call must pass the same scene graph.
+	 */
+	bool commit(SceneGraph &scene_graph, std::chrono::nanoseconds budget);
+
+	// the root of the first scene once committed
+	SceneNodeRef root() const;
+
+  private:
+	friend class GLtfLoader;
+
+	struct State;
+	std::unique_ptr<State> state;
+};
+
 class GLtfLoader
 {
   public:
 	SceneNodeRef load(const std::string &path, SceneGraph &scene_graph) const;
+
+	// parse and build the file on a background thread, progress is sent to events if given
+	// events are sent from the thread pool, so they must go to receivers that accept several senders
+	GltfLoad load_async(const std::string &path, Sender<GltfLoadEvent> *events = nullptr) const;
+
+	// decode images and build meshes and materials on a thread pool, nullptr to stay on the calling thread
+	void set_thread_pool(std::shared_ptr<ThreadPool> thread_pool)
+	{
+		this->thread_pool = std::move(thread_pool);
+	}
+
+  private:
+	std::shared_ptr<ThreadPool> thread_pool;
 };
 }        // namespace remus
@@ -1,21 +1,38 @@
 #include "gltf_loader.hpp"
 
 #include <common/logging.hpp>
+#include <loaders/mapped_file.hpp>
 
+#include <scene_graph/components/bounding_box.hpp>
 #include <scene_graph/components/material.hpp>
 #include <scene_graph/components/static_mesh.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <memory>
+
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <json.hpp>
+#include <stb_image.h>
 #include <tiny_gltf.h>
 
 namespace remus
 {
-inline AttributeType to_attribute_type(const std::string &tiny_gltf_attribute)
+// returns false for attributes a StaticMesh has no slot for, such as a third set of texture coordinates
+inline bool to_attribute_type(const std::string &tiny_gltf_attribute, AttributeType &type)
 {
 #define CASE(x)                    \
 	if (tiny_gltf_attribute == #x) \
-		return AttributeType::x;
+	{                              \
+		type = AttributeType::x;   \
+		return true;               \
+	}
 
 	CASE(POSITION)
 	CASE(NORMAL)
@@ -28,52 +45,652 @@ inline AttributeType to_attribute_type(const std::string &tiny_gltf_attribute)
 
 #undef CASE
 
-	LOG_ASSERT(false, "Unsupported attribute type: {}", tiny_gltf_attribute);
-	return AttributeType::POSITION;
+	return false;
 }
 
-inline PrimitiveTopology to_primitive_topology(int tiny_gltf_mode)
+// returns false for strips, fans and loops, which have no PrimitiveTopology
+inline bool to_primitive_topology(int tiny_gltf_mode, PrimitiveTopology &topology)
 {
 	switch (tiny_gltf_mode)
 	{
 		case TINYGLTF_MODE_TRIANGLES:
-			return PrimitiveTopology::TRIANGLES;
+			topology = PrimitiveTopology::TRIANGLES;
+			return true;
 		case TINYGLTF_MODE_LINE:
-			return PrimitiveTopology::LINES;
+			topology = PrimitiveTopology::LINES;
+			return true;
 		case TINYGLTF_MODE_POINTS:
-			return PrimitiveTopology::POINTS;
+			topology = PrimitiveTopology::POINTS;
+			return true;
 
 		default:
-			LOG_ASSERT(false, "Unsupported primitive topology: {}", tiny_gltf_mode);
-			return PrimitiveTopology::TRIANGLES;
+			return false;
+	}
+}
+
+// the bytes of a glTF buffer, owner keeps them alive, it is the mapping of a file or the decoded contents of a data uri
+struct BufferData
+{
+	std::shared_ptr<const void> owner;
+	const uint8_t              *data{nullptr};
+	size_t                      size{0};
+};
+
+// the chunks of a .glb file, pointing into its mapping
+struct GlbChunks
+{
+	const char    *json{nullptr};
+	size_t         json_size{0};
+	const uint8_t *bin{nullptr};
+	size_t         bin_size{0};
+};
+
+inline bool is_glb(const MappedFile &file)
+{
+	return file.size() >= 12 && std::memcmp(file.data(), "glTF", 4) == 0;
+}
+
+inline uint32_t read_u32(const uint8_t *data)
+{
+	// glTF is little endian, as are the platforms we run on
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline bool split_glb(const MappedFile &file, GlbChunks &chunks)
+{
+	constexpr uint32_t json_chunk = 0x4E4F534A;
+	constexpr uint32_t bin_chunk  = 0x004E4942;
+
+	const uint8_t *data = file.data();
+
+	if (read_u32(data + 4) != 2)
+	{
+		LOGE("GLTF loader: Unsupported .glb version {}", read_u32(data + 4));
+		return false;
+	}
+
+	size_t length = std::min<size_t>(read_u32(data + 8), file.size());
+	size_t offset = 12;
+
+	// the JSON chunk comes first and the binary chunk, if any, second, any others are skipped
+	while (offset + 8 <= length)
+	{
+		size_t chunk_length = read_u32(data + offset);
+		auto   chunk_type   = read_u32(data + offset + 4);
+		offset += 8;
+
+		if (chunk_length > length - offset)
+		{
+			LOGE("GLTF loader: Truncated .glb chunk");
+			return false;
+		}
+
+		if (chunk_type == json_chunk && !chunks.json)
+		{
+			chunks.json      = reinterpret_cast<const char *>(data + offset);
+			chunks.json_size = chunk_length;
+		}
+		else if (chunk_type == bin_chunk && !chunks.bin)
+		{
+			chunks.bin      = data + offset;
+			chunks.bin_size = chunk_length;
+		}
+
+		offset += chunk_length;
+	}
+
+	if (!chunks.json)
+	{
+		LOGE("GLTF loader: The .glb has no JSON chunk");
+		return false;
+	}
+	return true;
+}
+
+inline bool is_data_uri(const std::string &uri)
+{
+	return uri.compare(0, 5, "data:") == 0;
+}
+
+inline bool decode_data_uri(const std::string &uri, std::vector<uint8_t> &out)
+{
+	auto marker = uri.find(";base64,");
+	if (marker == std::string::npos)
+	{
+		return false;
+	}
+
+	auto sextet = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z')
+			return c - 'A';
+		if (c >= 'a' && c <= 'z')
+			return c - 'a' + 26;
+		if (c >= '0' && c <= '9')
+			return c - '0' + 52;
+		if (c == '+' || c == '-')
+			return 62;
+		if (c == '/' || c == '_')
+			return 63;
+		return -1;
+	};
+
+	out.clear();
+	out.reserve((uri.size() - marker) / 4 * 3);
+
+	uint32_t bits  = 0;
+	int      count = 0;
+	for (size_t i = marker + 8; i < uri.size() && uri[i] != '='; ++i)
+	{
+		int value = sextet(uri[i]);
+		if (value < 0)
+		{
+			return false;
+		}
+
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		count += 6;
+		if (count >= 8)
+		{
+			count -= 8;
+			out.push_back(static_cast<uint8_t>(bits >> count));
+		}
+	}
+	return true;
+}
+
+// resolve a relative uri against the directory of the glTF, undoing percent encoding
+inline std::string resolve_uri(const std::string &base_dir, const std::string &uri)
+{
+	std::string path = base_dir;
+	if (!path.empty())
+	{
+		path += '/';
+	}
+
+	for (size_t i = 0; i < uri.size(); ++i)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+		{
+			path += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+			i += 2;
+		}
+		else
+		{
+			path += uri[i];
+		}
+	}
+	return path;
+}
+
+inline bool get_unsigned(const nlohmann::json &object, const char *key, size_t &value)
+{
+	auto it = object.find(key);
+	if (it == object.end() || !it->is_number_unsigned())
+	{
+		return false;
+	}
+	value = it->get<size_t>();
+	return true;
+}
+
+inline bool get_string(const nlohmann::json &object, const char *key, std::string &value)
+{
+	auto it = object.find(key);
+	if (it == object.end() || !it->is_string())
+	{
+		return false;
+	}
+	value = it->get<std::string>();
+	return true;
+}
+
+// resolve every buffer of the document, the binary chunk of a .glb and external .bin files are used in place from their mapping
+inline bool load_buffers(const nlohmann::json &document, const std::string &base_dir, const std::shared_ptr<MappedFile> &file, const GlbChunks &chunks, std::vector<BufferData> &buffers)
+{
+	auto it = document.find("buffers");
+	if (it == document.end())
+	{
+		return true;
+	}
+
+	if (!it->is_array())
+	{
+		LOGE("GLTF loader: Invalid buffers");
+		return false;
+	}
+
+	for (auto &buffer : *it)
+	{
+		size_t      byte_length = 0;
+		std::string uri;
+
+		if (!buffer.is_object() || !get_unsigned(buffer, "byteLength", byte_length))
+		{
+			LOGE("GLTF loader: Buffer {} has no byteLength", buffers.size());
+			return false;
+		}
+
+		BufferData data;
+		if (!get_string(buffer, "uri", uri))
+		{
+			// only the first buffer of a .glb may leave out its uri, it is the binary chunk
+			if (!chunks.bin || !buffers.empty() || byte_length > chunks.bin_size)
+			{
+				LOGE("GLTF loader: Buffer {} has no uri and no binary chunk to refer to", buffers.size());
+				return false;
+			}
+			data.owner = file;
+			data.data  = chunks.bin;
+		}
+		else if (is_data_uri(uri))
+		{
+			auto decoded = std::make_shared<std::vector<uint8_t>>();
+			if (!decode_data_uri(uri, *decoded) || decoded->size() < byte_length)
+			{
+				LOGE("GLTF loader: Failed to decode the data uri of buffer {}", buffers.size());
+				return false;
+			}
+			data.data  = decoded->data();
+			data.owner = std::move(decoded);
+		}
+		else
+		{
+			auto path   = resolve_uri(base_dir, uri);
+			auto mapped = std::make_shared<MappedFile>(path);
+			if (!mapped->is_open() || mapped->size() < byte_length)
+			{
+				LOGE("GLTF loader: Failed to map buffer {}", path);
+				return false;
+			}
+			data.data  = mapped->data();
+			data.owner = std::move(mapped);
+		}
+		data.size = byte_length;
+
+		buffers.push_back(std::move(data));
 	}
+	return true;
 }
 
-inline std::vector<uint8_t> load_buffer_from_accessor(tinygltf::Model &model, int index)
+inline ImagePtr decode_image(const uint8_t *encoded, size_t size)
+{
+	if (!encoded || size > INT_MAX)
+	{
+		return nullptr;
+	}
+
+	// decoded to 8 bit RGBA like tinygltf does
+	int  width, height, channels;
+	auto pixels = stbi_load_from_memory(encoded, static_cast<int>(size), &width, &height, &channels, 4);
+	if (!pixels)
+	{
+		return nullptr;
+	}
+
+	auto image    = std::make_shared<Image>();
+	image->width  = static_cast<size_t>(width);
+	image->height = static_cast<size_t>(height);
+	image->data.assign(pixels, pixels + image->width * image->height * 4);
+	stbi_image_free(pixels);
+	return image;
+}
+
+// decode an image of the document from its buffer view, data uri or external file
+inline ImagePtr load_image(const nlohmann::json &image, const tinygltf::Model &model, const std::vector<BufferData> &buffers, const std::string &base_dir)
+{
+	size_t      view_index = 0;
+	std::string uri;
+
+	if (image.is_object() && get_unsigned(image, "bufferView", view_index))
+	{
+		if (view_index >= model.bufferViews.size())
+		{
+			return nullptr;
+		}
+
+		auto &view = model.bufferViews[view_index];
+		if (view.buffer < 0 || static_cast<size_t>(view.buffer) >= buffers.size())
+		{
+			return nullptr;
+		}
+
+		auto &buffer = buffers[view.buffer];
+		if (view.byteOffset > buffer.size || view.byteLength > buffer.size - view.byteOffset)
+		{
+			return nullptr;
+		}
+		return decode_image(buffer.data + view.byteOffset, view.byteLength);
+	}
+
+	if (!image.is_object() || !get_string(image, "uri", uri))
+	{
+		return nullptr;
+	}
+
+	if (is_data_uri(uri))
+	{
+		std::vector<uint8_t> decoded;
+		if (!decode_data_uri(uri, decoded))
+		{
+			return nullptr;
+		}
+		return decode_image(decoded.data(), decoded.size());
+	}
+
+	MappedFile file(resolve_uri(base_dir, uri));
+	return decode_image(file.data(), file.size());
+}
+
+// a view of an accessor into its buffer, sharing the buffer rather than copying from it
+inline AccessorView load_accessor_view(const tinygltf::Model &model, const std::vector<BufferData> &buffers, int index)
 {
 	if (index < 0)
 	{
 		return {};
 	}
 
+	if (static_cast<size_t>(index) >= model.accessors.size())
+	{
+		LOGW("GLTF loader: Accessor {} does not exist", index);
+		return {};
+	}
+
 	auto &accessor = model.accessors[index];
-	auto &view     = model.bufferViews[accessor.bufferView];
-	auto &buffer   = model.buffers[view.buffer];
+	if (accessor.bufferView < 0 || static_cast<size_t>(accessor.bufferView) >= model.bufferViews.size())
+	{
+		LOGW("GLTF loader: Accessor {} has no buffer view, sparse accessors are not supported", index);
+		return {};
+	}
+
+	auto &view = model.bufferViews[accessor.bufferView];
+	if (view.buffer < 0 || static_cast<size_t>(view.buffer) >= buffers.size())
+	{
+		LOGW("GLTF loader: Buffer view {} has no buffer", accessor.bufferView);
+		return {};
+	}
 
-	size_t offset = accessor.byteOffset + view.byteOffset;
-	size_t size   = accessor.count * tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type);
+	auto &buffer = buffers[view.buffer];
+	if (view.byteOffset > buffer.size || view.byteLength > buffer.size - view.byteOffset)
+	{
+		LOGW("GLTF loader: Buffer view {} is out of the bounds of its buffer", accessor.bufferView);
+		return {};
+	}
 
-	return std::vector<uint8_t>(buffer.data.begin() + offset, buffer.data.begin() + offset + size);
+	int component_size  = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+	int component_count = tinygltf::GetNumComponentsInType(accessor.type);
+	int stride          = accessor.ByteStride(view);
+	if (component_size <= 0 || component_count <= 0 || stride <= 0)
+	{
+		LOGW("GLTF loader: Accessor {} has an invalid format or stride", index);
+		return {};
+	}
+
+	size_t element_size = static_cast<size_t>(component_size) * component_count;
+
+	// the accessor must stay within its view, checked by subtraction and division so that no sum or product can wrap
+	size_t available = accessor.byteOffset <= view.byteLength ? view.byteLength - accessor.byteOffset : 0;
+	if (accessor.byteOffset > view.byteLength ||
+	    (accessor.count > 0 && (element_size > available || accessor.count - 1 > (available - element_size) / static_cast<size_t>(stride))))
+	{
+		LOGW("GLTF loader: Accessor {} is out of the bounds of its buffer view", index);
+		return {};
+	}
+
+	// both are within the buffer, so the sum is too
+	size_t offset = view.byteOffset + accessor.byteOffset;
+
+	AccessorView accessor_view;
+	accessor_view.data         = std::shared_ptr<const uint8_t>(buffer.owner, buffer.data + offset);
+	accessor_view.count        = accessor.count;
+	accessor_view.element_size = element_size;
+	accessor_view.stride       = static_cast<size_t>(stride);
+	return accessor_view;
 }
 
-SceneNodeRef GLtfLoader::load(const std::string &path, SceneGraph &scene_graph) const
+inline BoundingBox load_bounding_box(const tinygltf::Accessor &accessor, const AccessorView &positions)
+{
+	BoundingBox box;
+
+	// glTF requires the bounds of POSITION accessors, the positions are only read if an exporter left them out
+	if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3)
+	{
+		box.min = glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
+		box.max = glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
+		return box;
+	}
+
+	if (accessor.type != TINYGLTF_TYPE_VEC3 || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || positions.empty())
+	{
+		LOGW("GLTF loader: Unsupported POSITION format, the mesh has no bounding box");
+		return box;
+	}
+
+	for (size_t i = 0; i < positions.count; ++i)
+	{
+		glm::vec3 position;
+		std::memcpy(&position, positions.element(i), sizeof(position));
+		box.merge(position);
+	}
+
+	return box;
+}
+
+// a primitive of a glTF mesh, ready to be added to a node
+struct MeshPrimitive
 {
-	tinygltf::Model    model;
+	StaticMeshPtr static_mesh;
+	BoundingBox   bounding_box;
+	int           material{-1};
+};
+
+// a parsed glTF file and the components built from it
+struct GltfScene
+{
+	tinygltf::Model         model;
+	std::string             base_dir;
+	std::vector<BufferData> buffers;
+	nlohmann::json          image_sources;
+
+	std::vector<ImagePtr>                   images;           // by glTF image index
+	std::vector<PBRMaterialPtr>             materials;        // by glTF material index
+	std::vector<std::vector<MeshPrimitive>> meshes;           // by glTF mesh index
+};
+
+// sends the progress of a load, if anyone is listening
+struct GltfProgress
+{
+	std::string            path;
+	Sender<GltfLoadEvent> *events{nullptr};
+
+	void report(GltfLoadStage stage, size_t completed = 0, size_t total = 0) const
+	{
+		if (events)
+		{
+			events->send(GltfLoadEvent{path, stage, completed, total});
+		}
+	}
+};
+
+// call func(i) for every i in [0, count), spread over the thread pool if there is one, reporting each item of the stage as it completes
+template <typename Func>
+void for_each_index(ThreadPool *thread_pool, size_t count, const GltfProgress &progress, GltfLoadStage stage, Func &&func)
+{
+	progress.report(stage, 0, count);
+
+	std::atomic<size_t> completed{0};
+
+	auto run = [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+		{
+			func(i);
+			progress.report(stage, ++completed, count);
+		}
+	};
+
+	if (thread_pool)
+	{
+		thread_pool->parallel_for(count, 1, run);
+	}
+	else
+	{
+		run(0, count);
+	}
+}
+
+inline PBRMaterialPtr load_material(const tinygltf::Material &material, const tinygltf::Model &model, const std::vector<ImagePtr> &images)
+{
+	auto  material_ptr = std::make_shared<PBRMaterial>();
+	auto &pbr_material = *material_ptr;
+	pbr_material.metallic_factor    = material.pbrMetallicRoughness.metallicFactor;
+	pbr_material.roughness_factor   = material.pbrMetallicRoughness.roughnessFactor;
+	pbr_material.normal_scale       = material.normalTexture.scale;
+	pbr_material.occlusion_strength = material.occlusionTexture.strength;
+
+	// the emissive factor is an RGB triple
+	if (material.emissiveFactor.size() >= 3)
+	{
+		pbr_material.emissive_factor = glm::vec4(material.emissiveFactor[0], material.emissiveFactor[1], material.emissiveFactor[2], 1.0f);
+	}
+
+	if (material.pbrMetallicRoughness.baseColorFactor.size() == 4)
+	{
+		pbr_material.base_color_factor = glm::make_vec4(material.pbrMetallicRoughness.baseColorFactor.data());
+	}
+
+	auto lookup_image = [&](int texture_index) -> ImagePtr {
+		if (texture_index < 0 || static_cast<size_t>(texture_index) >= model.textures.size())
+		{
+			return nullptr;
+		}
+
+		auto &texture = model.textures[texture_index];
+		if (texture.source > -1 && static_cast<size_t>(texture.source) < images.size())
+		{
+			return images[texture.source];
+		}
+		return nullptr;
+	};
+
+	pbr_material.base_color_texture         = lookup_image(material.pbrMetallicRoughness.baseColorTexture.index);
+	pbr_material.metallic_roughness_texture = lookup_image(material.pbrMetallicRoughness.metallicRoughnessTexture.index);
+	pbr_material.normal_texture             = lookup_image(material.normalTexture.index);
+	pbr_material.occlusion_texture          = lookup_image(material.occlusionTexture.index);
+	pbr_material.emissive_texture           = lookup_image(material.emissiveTexture.index);
+
+	return material_ptr;
+}
+
+inline std::vector<MeshPrimitive> load_mesh(const tinygltf::Mesh &mesh, const tinygltf::Model &model, const std::vector<BufferData> &buffers)
+{
+	std::vector<MeshPrimitive> primitives;
+	primitives.reserve(mesh.primitives.size());
+
+	for (auto &primitive : mesh.primitives)
+	{
+		PrimitiveTopology topology;
+		if (!to_primitive_topology(primitive.mode, topology))
+		{
+			LOGW("GLTF loader: Unsupported primitive topology {} in mesh {}, the primitive is skipped", primitive.mode, mesh.name);
+			continue;
+		}
+
+		MeshPrimitive mesh_primitive;
+		mesh_primitive.material    = primitive.material;
+		mesh_primitive.static_mesh = std::make_shared<StaticMesh>();
+
+		auto &static_mesh         = *mesh_primitive.static_mesh;
+		static_mesh.topology      = topology;
+		static_mesh.indices       = load_accessor_view(model, buffers, primitive.indices);
+		static_mesh.indices_count = static_mesh.indices.count;
+
+		for (auto &attributes : primitive.attributes)
+		{
+			AttributeType type;
+			if (!to_attribute_type(attributes.first, type))
+			{
+				LOGW("GLTF loader: Unsupported attribute {} in mesh {}, the attribute is skipped", attributes.first, mesh.name);
+				continue;
+			}
+
+			auto view = load_accessor_view(model, buffers, attributes.second);
+
+			// an accessor which failed to load may not even exist
+			if (attributes.first == "POSITION" && !view.empty())
+			{
+				mesh_primitive.bounding_box = load_bounding_box(model.accessors[attributes.second], view);
+			}
+
+			static_mesh.attributes.emplace(type, std::move(view));
+		}
+
+		primitives.push_back(std::move(mesh_primitive));
+	}
+
+	return primitives;
+}
+
+// map the file and parse its JSON, the buffers are resolved but nothing is decoded yet
+inline bool parse_gltf(const std::string &path, GltfScene &scene)
+{
+	// the file is mapped rather than read, a .glb is used in place and only its JSON is parsed
+	auto file = std::make_shared<MappedFile>(path);
+	if (!file->is_open())
+	{
+		LOGE("GLTF loader: Failed to open {}", path);
+		return false;
+	}
+
+	GlbChunks chunks;
+	if (is_glb(*file))
+	{
+		if (!split_glb(*file, chunks))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		chunks.json      = reinterpret_cast<const char *>(file->data());
+		chunks.json_size = file->size();
+	}
+
+	auto separator = path.find_last_of("/\\");
+	scene.base_dir = separator == std::string::npos ? "" : path.substr(0, separator);
+
+	auto document = nlohmann::json::parse(chunks.json, chunks.json + chunks.json_size, nullptr, false);
+	if (!document.is_object())
+	{
+		LOGE("GLTF loader: Failed to parse the JSON of {}", path);
+		return false;
+	}
+
+	// buffers and images are loaded here so tinygltf does not read them into memory
+	if (!load_buffers(document, scene.base_dir, file, chunks, scene.buffers))
+	{
+		return false;
+	}
+
+	if (document.contains("images"))
+	{
+		scene.image_sources = std::move(document["images"]);
+	}
+	document.erase("buffers");
+	document.erase("images");
+
+	auto json = document.dump();
+	if (json.size() > UINT_MAX)
+	{
+		LOGE("GLTF loader: The JSON of {} is too large", path);
+		return false;
+	}
+
 	tinygltf::TinyGLTF loader;
 	std::string        error;
 	std::string        warning;
 
-	bool ret = loader.LoadASCIIFromFile(&model, &error, &warning, path);
+	bool ret = loader.LoadASCIIFromString(&scene.model, &error, &warning, json.c_str(), static_cast<unsigned int>(json.size()), scene.base_dir);
 
 	if (!warning.empty())
 	{
@@ -88,174 +705,382 @@ SceneNodeRef GLtfLoader::load(const std::string &path, SceneGraph &scene_graph)
 	if (!ret)
 	{
 		LOGE("GLTF loader: Failed to parse glTF");
-		return {};
+		return false;
+	}
+
+	return true;
+}
+
+// decode the images, then build the materials and meshes, every item of a stage is independent so each stage is spread over the thread pool
+inline void build_gltf(GltfScene &scene, ThreadPool *thread_pool, const GltfProgress &progress)
+{
+	auto &model = scene.model;
+
+	const auto &image_sources = scene.image_sources;
+
+	size_t image_count = image_sources.is_array() ? image_sources.size() : 0;
+	scene.images.resize(image_count);
+	for_each_index(thread_pool, image_count, progress, GltfLoadStage::DecodingImages, [&](size_t i) {
+		scene.images[i] = load_image(image_sources[i], model, scene.buffers, scene.base_dir);
+		if (!scene.images[i])
+		{
+			LOGW("GLTF loader: Failed to load image {}", i);
+		}
+	});
+
+	scene.materials.resize(model.materials.size());
+	for_each_index(thread_pool, model.materials.size(), progress, GltfLoadStage::BuildingMaterials, [&](size_t i) {
+		scene.materials[i] = load_material(model.materials[i], model, scene.images);
+	});
+
+	scene.meshes.resize(model.meshes.size());
+	for_each_index(thread_pool, model.meshes.size(), progress, GltfLoadStage::BuildingMeshes, [&](size_t i) {
+		scene.meshes[i] = load_mesh(model.meshes[i], model, scene.buffers);
+	});
+}
+
+inline void load_transform(const tinygltf::Node &node, Transform &transform)
+{
+	if (node.translation.size() == 3)
+	{
+		transform.translation = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
 	}
 
-	std::vector<ImagePtr> images;
-	images.reserve(model.images.size());
-	for (auto &image : model.images)
+	if (node.rotation.size() == 4)
 	{
-		Image image_data;
-		image_data.width  = image.width;
-		image_data.height = image.height;
-		image_data.data   = image.image;
-		images.push_back(std::make_shared<Image>(image_data));
+		transform.rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
 	}
 
-	std::vector<SceneNodeRef> nodes;
-	nodes.reserve(model.nodes.size());
+	if (node.scale.size() == 3)
+	{
+		transform.scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+	}
 
-	for (auto &node : model.nodes)
+	if (node.matrix.size() == 16)
 	{
-		SceneNodeRef n = scene_graph.create_node();
-		n.set_name(node.name);
+		// extract the matrix
+		glm::mat4 matrix;
+		std::transform(node.matrix.begin(), node.matrix.end(), glm::value_ptr(matrix), [](double d) { return static_cast<float>(d); });
+
+		// decompose the matrix
+		glm::vec3 skew(0.0f);
+		glm::vec4 perspective(0.0f);
+		glm::decompose(matrix, transform.scale, transform.rotation, transform.translation, skew, perspective);
+	}
+}
 
-		if (node.mesh > -1)
+/* Adds a built glTF file to a scene graph one step at a time, so that it can be spread over several frames.
+ * A step creates a node, relates the children of a node or creates a scene root.
+ * Nodes share the meshes and materials they reference rather than copying them.
+ */
+class GltfCommit
+{
+  public:
+	// take one step, returns false once there is nothing left to do
+	bool step(const GltfScene &scene, SceneGraph &scene_graph)
+	{
+		auto &model = scene.model;
+
+		if (nodes.size() < model.nodes.size())
 		{
-			auto &mesh = model.meshes[node.mesh];
+			create_node(scene, scene_graph, model.nodes[nodes.size()]);
+			return true;
+		}
 
-			bool should_create_subnodes = mesh.primitives.size() > 1;
+		// Relate tree heirarchy, the children of a node are moved in one batch
+		if (related_count < model.nodes.size())
+		{
+			children.clear();
+			for (auto &child_index : model.nodes[related_count].children)
+			{
+				children.push_back(nodes[child_index]);
+			}
+			scene_graph.set_parent(children.data(), children.size(), nodes[related_count]);
+
+			related_count++;
+			return true;
+		}
 
-			size_t primitive_index = 0;
-			for (auto &primitive : mesh.primitives)
+		// Relate scenes
+		if (scene_count < model.scenes.size())
+		{
+			auto &scene_description = model.scenes[scene_count];
+
+			auto scene_root = scene_graph.create_node();
+			scene_root.set_name(scene_description.name);
+
+			children.clear();
+			for (auto &node : scene_description.nodes)
 			{
-				StaticMesh static_mesh;
-				static_mesh.topology = to_primitive_topology(primitive.mode);
+				children.push_back(nodes[node]);
+			}
+			scene_graph.set_parent(children.data(), children.size(), scene_root);
 
-				auto &indices_accessor    = model.accessors[primitive.indices];
-				static_mesh.indices_count = indices_accessor.count;
-				static_mesh.indices       = load_buffer_from_accessor(model, primitive.indices);
+			// take the first loaded scene
+			if (!root.is_valid())
+			{
+				root = scene_root;
+			}
 
-				for (auto attributes : primitive.attributes)
-				{
-					static_mesh.attributes.emplace(to_attribute_type(attributes.first), load_buffer_from_accessor(model, attributes.second));
-				}
+			scene_count++;
+			return true;
+		}
 
-				if (primitive.material > -1)
-				{
-					auto &material = model.materials[primitive.material];
-
-					PBRMaterial pbr_material;
-					pbr_material.metallic_factor    = material.pbrMetallicRoughness.metallicFactor;
-					pbr_material.roughness_factor   = material.pbrMetallicRoughness.roughnessFactor;
-					pbr_material.normal_scale       = material.normalTexture.scale;
-					pbr_material.occlusion_strength = material.occlusionTexture.strength;
-					pbr_material.emissive_factor    = glm::make_vec4(material.emissiveFactor.data());
-					pbr_material.base_color_factor  = glm::make_vec4(material.pbrMetallicRoughness.baseColorFactor.data());
-
-					auto lookup_image = [&](int texture_index) -> ImagePtr {
-						auto &texture = model.textures[texture_index];
-						if (texture.source > -1)
-						{
-							return images[texture.source];
-						}
-						return nullptr;
-					};
-
-					if (material.pbrMetallicRoughness.baseColorTexture.index > -1)
-					{
-						pbr_material.base_color_texture = lookup_image(material.pbrMetallicRoughness.baseColorTexture.index);
-					}
-
-					if (material.pbrMetallicRoughness.metallicRoughnessTexture.index > -1)
-					{
-						pbr_material.metallic_roughness_texture = lookup_image(material.pbrMetallicRoughness.metallicRoughnessTexture.index);
-					}
-
-					if (material.normalTexture.index > -1)
-					{
-						pbr_material.normal_texture = lookup_image(material.normalTexture.index);
-					}
-
-					if (material.occlusionTexture.index > -1)
-					{
-						pbr_material.occlusion_texture = lookup_image(material.occlusionTexture.index);
-					}
-
-					if (material.emissiveTexture.index > -1)
-					{
-						pbr_material.emissive_texture = lookup_image(material.emissiveTexture.index);
-					}
-
-					n.add_component(pbr_material);
-				}
+		return false;
+	}
+
+	// the number of steps taken and the number there are in all
+	size_t completed() const
+	{
+		return nodes.size() + related_count + scene_count;
+	}
+
+	static size_t total(const GltfScene &scene)
+	{
+		return scene.model.nodes.size() * 2 + scene.model.scenes.size();
+	}
 
-				if (should_create_subnodes)
+	bool finished(const GltfScene &scene) const
+	{
+		return completed() == total(scene);
+	}
+
+	SceneNodeRef root{};
+
+  private:
+	std::vector<SceneNodeRef> nodes;
+	std::vector<SceneNodeRef> children;
+	size_t                    related_count{0};
+	size_t                    scene_count{0};
+
+	void create_node(const GltfScene &scene, SceneGraph &scene_graph, const tinygltf::Node &node)
+	{
+		auto &model = scene.model;
+
+		SceneNodeRef n = scene_graph.create_node();
+		n.set_name(node.name);
+
+		if (node.mesh > -1 && static_cast<size_t>(node.mesh) < scene.meshes.size())
+		{
+			auto &primitives = scene.meshes[node.mesh];
+
+			// a node holds one primitive, the primitives of a mesh with several go to child nodes
+			if (primitives.size() > 1)
+			{
+				auto &mesh_name = model.meshes[node.mesh].name;
+				for (size_t primitive_index = 0; primitive_index < primitives.size(); primitive_index++)
 				{
 					auto subnode = scene_graph.create_node();
-					subnode.set_name(node.name + "_" + mesh.name + "_primitive_" + std::to_string(primitive_index));
-					subnode.add_component(static_mesh);
+					subnode.set_name(node.name + "_" + mesh_name + "_primitive_" + std::to_string(primitive_index));
+					add_primitive(scene, subnode, primitives[primitive_index]);
 					subnode.set_parent(n);
 				}
-				else
-				{
-					n.add_component(static_mesh);
-				}
-
-				primitive_index++;
+			}
+			else if (primitives.size() == 1)
+			{
+				add_primitive(scene, n, primitives.front());
 			}
 		}
 
-		auto &transform = n.transform();
+		load_transform(node, n.transform());
 
-		if (node.translation.size() == 3)
-		{
-			transform.translation = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
-		}
+		nodes.push_back(n);
+	}
+
+	static void add_primitive(const GltfScene &scene, SceneNodeRef &node, const MeshPrimitive &primitive)
+	{
+		node.add_component(primitive.static_mesh);
 
-		if (node.rotation.size() == 4)
+		if (!primitive.bounding_box.empty())
 		{
-			transform.rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+			node.add_component(primitive.bounding_box);
 		}
 
-		if (node.scale.size() == 3)
+		if (primitive.material > -1 && static_cast<size_t>(primitive.material) < scene.materials.size())
 		{
-			transform.scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+			node.add_component(scene.materials[primitive.material]);
 		}
+	}
+};
+
+SceneNodeRef GLtfLoader::load(const std::string &path, SceneGraph &scene_graph) const
+{
+	GltfScene scene;
+	if (!parse_gltf(path, scene))
+	{
+		return {};
+	}
+
+	build_gltf(scene, thread_pool.get(), {});
+
+	GltfCommit commit;
+	while (commit.step(scene, scene_graph))
+	{
+	}
+
+	return commit.root;
+}
 
-		if (node.matrix.size() == 16)
+struct GltfLoad::State
+{
+	GltfProgress progress;
+	GltfScene    scene;
+	GltfCommit   commit;
+
+	std::atomic<bool> failed{false};
+	bool              done{false};
+
+	// the background parse and build, set last so it is waited on before anything else is destroyed
+	std::future<void> built;
+};
+
+GltfLoad GLtfLoader::load_async(const std::string &path, Sender<GltfLoadEvent> *events) const
+{
+	GltfLoad load;
+	load.state           = std::make_unique<GltfLoad::State>();
+	load.state->progress = GltfProgress{path, events};
+
+	auto *state = load.state.get();
+
+	state->built = std::async(std::launch::async, [state, thread_pool = thread_pool]() {
+		// the scene may be half built, it is never committed
+		auto fail = [state]() {
+			state->failed = true;
+			state->progress.report(GltfLoadStage::Failed);
+		};
+
+		try
 		{
-			// extract the matrix
-			glm::mat4 matrix;
-			std::transform(node.matrix.begin(), node.matrix.end(), glm::value_ptr(matrix), [](double d) { return static_cast<float>(d); });
+			state->progress.report(GltfLoadStage::Parsing, 0, 1);
+			if (!parse_gltf(state->progress.path, state->scene))
+			{
+				fail();
+				return;
+			}
+			state->progress.report(GltfLoadStage::Parsing, 1, 1);
 
-			// decompose the matrix
-			glm::vec3 skew(0.0f);
-			glm::vec4 perspective(0.0f);
-			glm::decompose(matrix, transform.scale, transform.rotation, transform.translation, skew, perspective);
+			build_gltf(state->scene, thread_pool.get(), state->progress);
+
+			state->progress.report(GltfLoadStage::Ready);
+		}
+		catch (const std::exception &e)
+		{
+			LOGE("GLTF loader: Failed to load {}: {}", state->progress.path, e.what());
+			fail();
 		}
+		catch (...)
+		{
+			// LOG_ASSERT throws a plain string
+			LOGE("GLTF loader: Failed to load {}", state->progress.path);
+			fail();
+		}
+	});
 
-		nodes.push_back(n);
+	return load;
+}
+
+GltfLoad::GltfLoad() = default;
+
+GltfLoad::~GltfLoad()
+{
+	wait();
+}
+
+GltfLoad::GltfLoad(GltfLoad &&other) noexcept :
+    state(std::move(other.state))
+{
+}
+
+GltfLoad &GltfLoad::operator=(GltfLoad &&other) noexcept
+{
+	if (this != &other)
+	{
+		wait();
+		state = std::move(other.state);
 	}
+	return *this;
+}
 
-	// Relate tree heirarchy
-	for (size_t node_index = 0; node_index < model.nodes.size(); node_index++)
+bool GltfLoad::ready() const
+{
+	if (!state)
 	{
-		for (auto &child_index : model.nodes[node_index].children)
-		{
-			nodes[child_index].set_parent(nodes[node_index]);
-		}
+		return false;
 	}
+	return !state->built.valid() || state->built.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
 
-	// Relate scenes
-	SceneNodeRef root{};
-	for (auto &scene : model.scenes)
+void GltfLoad::wait() const
+{
+	if (state && state->built.valid())
 	{
-		auto scene_root = scene_graph.create_node();
-		scene_root.set_name(scene.name);
+		state->built.wait();
+	}
+}
+
+bool GltfLoad::failed() const
+{
+	return !state || state->failed;
+}
 
-		for (auto &node : scene.nodes)
+bool GltfLoad::commit(SceneGraph &scene_graph, std::chrono::nanoseconds budget)
+{
+	if (!state || state->done)
+	{
+		return true;
+	}
+
+	if (!ready())
+	{
+		return false;
+	}
+
+	// rethrows anything the background work threw, only once, so the load is failed before that
+	if (state->built.valid())
+	{
+		try
 		{
-			nodes[node].set_parent(scene_root);
+			state->built.get();
 		}
-
-		// take the first loaded scene
-		if (!root.is_valid())
+		catch (...)
 		{
-			root = scene_root;
+			state->failed = true;
+			state->done   = true;
+			throw;
 		}
 	}
 
-	return root;
+	if (state->failed)
+	{
+		state->done = true;
+		return true;
+	}
+
+	auto &scene    = state->scene;
+	auto &commit   = state->commit;
+	auto  deadline = std::chrono::steady_clock::now() + budget;
+
+	while (commit.step(scene, scene_graph) && !commit.finished(scene) && std::chrono::steady_clock::now() < deadline)
+	{
+	}
+
+	if (commit.finished(scene))
+	{
+		state->done = true;
+		state->progress.report(GltfLoadStage::Done);
+		return true;
+	}
+
+	state->progress.report(GltfLoadStage::Committing, commit.completed(), GltfCommit::total(scene));
+	return false;
+}
+
+SceneNodeRef GltfLoad::root() const
+{
+	if (!state || !state->done)
+	{
+		return {};
+	}
+	return state->commit.root;
 }
 }        // namespace remus
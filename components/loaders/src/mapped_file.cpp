@@ -0,0 +1,155 @@
+#include <loaders/mapped_file.hpp>
+
+#include <utility>
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace remus
+{
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string &path)
+{
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		return;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		close();
+		return;
+	}
+
+	length = static_cast<size_t>(file_size.QuadPart);
+	open   = true;
+
+	// an empty file can not be mapped
+	if (length == 0)
+	{
+		return;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		close();
+		return;
+	}
+
+	bytes = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!bytes)
+	{
+		close();
+	}
+}
+
+void MappedFile::close()
+{
+	if (bytes)
+	{
+		UnmapViewOfFile(bytes);
+	}
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+	if (file)
+	{
+		CloseHandle(file);
+	}
+
+	bytes   = nullptr;
+	length  = 0;
+	open    = false;
+	mapping = nullptr;
+	file    = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+{
+	int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return;
+	}
+
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode))
+	{
+		::close(descriptor);
+		return;
+	}
+
+	length = static_cast<size_t>(status.st_size);
+	open   = true;
+
+	// an empty file can not be mapped
+	if (length > 0)
+	{
+		void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapped == MAP_FAILED)
+		{
+			length = 0;
+			open   = false;
+		}
+		else
+		{
+			bytes = static_cast<const uint8_t *>(mapped);
+		}
+	}
+
+	// the mapping keeps the file alive
+	::close(descriptor);
+}
+
+void MappedFile::close()
+{
+	if (bytes)
+	{
+		munmap(const_cast<uint8_t *>(bytes), length);
+	}
+
+	bytes  = nullptr;
+	length = 0;
+	open   = false;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		std::swap(bytes, other.bytes);
+		std::swap(length, other.length);
+		std::swap(open, other.open);
+#if defined(_WIN32)
+		std::swap(file, other.file);
+		std::swap(mapping, other.mapping);
+#endif
+	}
+	return *this;
+}
+}        // namespace remus
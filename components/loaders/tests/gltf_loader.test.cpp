@@ -1,9 +1,18 @@
 #include <loaders/models/gltf_loader.hpp>
 
 #include <common/logging.hpp>
+#include <scene_graph/components/bounding_box.hpp>
+#include <scene_graph/components/material.hpp>
 #include <scene_graph/components/static_mesh.hpp>
 #include <scene_graph/scene_graph.hpp>
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Load a glTF file", "[scene_graph]")
@@ -15,3 +24,628 @@ TEST_CASE("Load a glTF file", "[scene_graph]")
 	auto node = gltf_loader.load("./assets/porsche_911/scene.gltf", scene_graph);
 	REQUIRE(node.is_valid());
 }
+
+namespace
+{
+// a red 1x1 RGBA png
+const uint8_t png[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1f, 0x15, 0xc4, 0x89, 0x00, 0x00, 0x00,
+    0x0d, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0xfc, 0xcf, 0xc0, 0xf0, 0x1f, 0x00, 0x05, 0x05, 0x02, 0x00,
+    0x5f, 0xc8, 0xf1, 0xd2, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82};
+
+// the positions of a triangle, its indices padded to 4 bytes, then the png
+std::vector<uint8_t> triangle_buffer()
+{
+	const float    positions[9] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+	const uint16_t indices[4]   = {0, 1, 2, 0};
+
+	std::vector<uint8_t> buffer(sizeof(positions) + sizeof(indices) + sizeof(png));
+	std::memcpy(buffer.data(), positions, sizeof(positions));
+	std::memcpy(buffer.data() + sizeof(positions), indices, sizeof(indices));
+	std::memcpy(buffer.data() + sizeof(positions) + sizeof(indices), png, sizeof(png));
+	return buffer;
+}
+
+// a textured triangle whose only buffer is described by buffer
+std::string triangle_json(const std::string &buffer)
+{
+	return R"({"asset": {"version": "2.0"},
+		"scenes": [{"name": "scene", "nodes": [0]}],
+		"nodes": [{"name": "triangle", "mesh": 0}],
+		"meshes": [{"name": "mesh", "primitives": [{"attributes": {"POSITION": 0}, "indices": 1, "material": 0}]}],
+		"materials": [{"pbrMetallicRoughness": {"baseColorTexture": {"index": 0}}}],
+		"textures": [{"source": 0}],
+		"images": [{"bufferView": 2, "mimeType": "image/png"}],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]},
+			{"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 36},
+			{"buffer": 0, "byteOffset": 36, "byteLength": 6},
+			{"buffer": 0, "byteOffset": 44, "byteLength": 70}],
+		"buffers": [)" +
+	       buffer + "]}";
+}
+
+std::string base64(const std::vector<uint8_t> &data)
+{
+	const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string out;
+	for (size_t i = 0; i < data.size(); i += 3)
+	{
+		uint32_t bits = data[i] << 16;
+		if (i + 1 < data.size())
+			bits |= data[i + 1] << 8;
+		if (i + 2 < data.size())
+			bits |= data[i + 2];
+
+		out += alphabet[(bits >> 18) & 63];
+		out += alphabet[(bits >> 12) & 63];
+		out += i + 1 < data.size() ? alphabet[(bits >> 6) & 63] : '=';
+		out += i + 2 < data.size() ? alphabet[bits & 63] : '=';
+	}
+	return out;
+}
+
+void write_file(const std::filesystem::path &path, const void *data, size_t size)
+{
+	std::ofstream file(path, std::ios::binary);
+	file.write(static_cast<const char *>(data), size);
+}
+
+void append_u32(std::vector<uint8_t> &out, uint32_t value)
+{
+	out.insert(out.end(), reinterpret_cast<const uint8_t *>(&value), reinterpret_cast<const uint8_t *>(&value) + sizeof(value));
+}
+
+// a .glb holding json and bin, each chunk padded to 4 bytes
+std::vector<uint8_t> make_glb(std::string json, std::vector<uint8_t> bin)
+{
+	json.resize((json.size() + 3) & ~size_t{3}, ' ');
+	bin.resize((bin.size() + 3) & ~size_t{3}, 0);
+
+	std::vector<uint8_t> glb;
+	append_u32(glb, 0x46546C67);
+	append_u32(glb, 2);
+	append_u32(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+	append_u32(glb, static_cast<uint32_t>(json.size()));
+	append_u32(glb, 0x4E4F534A);
+	glb.insert(glb.end(), json.begin(), json.end());
+	append_u32(glb, static_cast<uint32_t>(bin.size()));
+	append_u32(glb, 0x004E4942);
+	glb.insert(glb.end(), bin.begin(), bin.end());
+	return glb;
+}
+
+void require_triangle(remus::SceneGraph &scene_graph)
+{
+	auto &registry = scene_graph.registry();
+
+	size_t mesh_count = 0;
+	for (auto entity : registry.view<remus::StaticMeshPtr>())
+	{
+		auto &mesh = *registry.get<remus::StaticMeshPtr>(entity);
+		REQUIRE(mesh.indices_count == 3);
+		REQUIRE(mesh.indices.size() == 6);
+
+		auto &positions = mesh.attributes.at(remus::AttributeType::POSITION);
+		REQUIRE(positions.size() == 36);
+		REQUIRE(positions.is_packed());
+
+		float x;
+		std::memcpy(&x, positions.element(1), sizeof(x));
+		REQUIRE(x == 1.0f);
+
+		// the views share the buffer instead of copying from it
+		REQUIRE_FALSE(positions.data.owner_before(mesh.indices.data));
+		REQUIRE_FALSE(mesh.indices.data.owner_before(positions.data));
+
+		auto &texture = registry.get<remus::PBRMaterialPtr>(entity)->base_color_texture;
+		REQUIRE(texture);
+		REQUIRE(texture->width == 1);
+		REQUIRE(texture->height == 1);
+		REQUIRE(texture->data.size() == 4);
+		REQUIRE(texture->data[0] == 255);
+
+		mesh_count++;
+	}
+	REQUIRE(mesh_count == 1);
+}
+}        // namespace
+
+TEST_CASE("Load a binary glTF file", "[loaders]")
+{
+	auto path = std::filesystem::temp_directory_path() / "remus_triangle.glb";
+	auto glb  = make_glb(triangle_json(R"({"byteLength": 114})"), triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	remus::SceneGraph scene_graph;
+	remus::GLtfLoader gltf_loader;
+
+	auto node = gltf_loader.load(path.string(), scene_graph);
+	REQUIRE(node.is_valid());
+	REQUIRE(node.get_name() == "scene");
+	require_triangle(scene_graph);
+
+	// a truncated file fails to load
+	write_file(path, glb.data(), glb.size() / 2);
+	REQUIRE(gltf_loader.load(path.string(), scene_graph).is_valid() == false);
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file with external and embedded buffers", "[loaders]")
+{
+	auto directory = std::filesystem::temp_directory_path();
+	auto buffer    = triangle_buffer();
+
+	remus::GLtfLoader gltf_loader;
+
+	SECTION("external")
+	{
+		// the uri is percent encoded
+		write_file(directory / "remus triangle.bin", buffer.data(), buffer.size());
+		auto json = triangle_json(R"({"byteLength": 114, "uri": "remus%20triangle.bin"})");
+		write_file(directory / "remus_triangle.gltf", json.data(), json.size());
+
+		{
+			remus::SceneGraph scene_graph;
+			REQUIRE(gltf_loader.load((directory / "remus_triangle.gltf").string(), scene_graph).is_valid());
+			require_triangle(scene_graph);
+		}
+
+		// the meshes kept the file mapped until the scene graph was destroyed
+		std::filesystem::remove(directory / "remus triangle.bin");
+	}
+
+	SECTION("data uri")
+	{
+		auto json = triangle_json(R"({"byteLength": 114, "uri": "data:application/octet-stream;base64,)" + base64(buffer) + "\"}");
+		write_file(directory / "remus_triangle.gltf", json.data(), json.size());
+
+		remus::SceneGraph scene_graph;
+		REQUIRE(gltf_loader.load((directory / "remus_triangle.gltf").string(), scene_graph).is_valid());
+		require_triangle(scene_graph);
+	}
+
+	SECTION("missing buffer")
+	{
+		auto json = triangle_json(R"({"byteLength": 114, "uri": "remus_missing.bin"})");
+		write_file(directory / "remus_triangle.gltf", json.data(), json.size());
+
+		remus::SceneGraph scene_graph;
+		REQUIRE(gltf_loader.load((directory / "remus_triangle.gltf").string(), scene_graph).is_valid() == false);
+	}
+
+	std::filesystem::remove(directory / "remus_triangle.gltf");
+}
+
+TEST_CASE("Interleaved attributes are viewed in place", "[loaders]")
+{
+	// position and normal of three vertices interleaved, then the indices
+	std::vector<float> vertices = {0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1};
+	uint16_t           indices[4] = {0, 1, 2, 0};
+
+	std::vector<uint8_t> buffer(vertices.size() * sizeof(float) + sizeof(indices));
+	std::memcpy(buffer.data(), vertices.data(), vertices.size() * sizeof(float));
+	std::memcpy(buffer.data() + vertices.size() * sizeof(float), indices, sizeof(indices));
+
+	auto json = std::string(R"({"asset": {"version": "2.0"},
+		"scenes": [{"nodes": [0]}],
+		"nodes": [{"mesh": 0}],
+		"meshes": [{"primitives": [{"attributes": {"POSITION": 0, "NORMAL": 1}, "indices": 2}]}],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"},
+			{"bufferView": 0, "byteOffset": 12, "componentType": 5126, "count": 3, "type": "VEC3"},
+			{"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 72, "byteStride": 24},
+			{"buffer": 0, "byteOffset": 72, "byteLength": 6}],
+		"buffers": [{"byteLength": 80}]})");
+
+	auto path = std::filesystem::temp_directory_path() / "remus_interleaved.glb";
+	auto glb  = make_glb(json, buffer);
+	write_file(path, glb.data(), glb.size());
+
+	{
+		remus::SceneGraph scene_graph;
+		remus::GLtfLoader gltf_loader;
+		REQUIRE(gltf_loader.load(path.string(), scene_graph).is_valid());
+
+		auto &registry = scene_graph.registry();
+		for (auto entity : registry.view<remus::StaticMeshPtr>())
+		{
+			auto &mesh = *registry.get<remus::StaticMeshPtr>(entity);
+			REQUIRE(mesh.indices_count == 3);
+			REQUIRE(mesh.indices.element_size == 2);
+
+			auto &positions = mesh.attributes.at(remus::AttributeType::POSITION);
+			auto &normals   = mesh.attributes.at(remus::AttributeType::NORMAL);
+			REQUIRE(positions.stride == 24);
+			REQUIRE(normals.stride == 24);
+			REQUIRE(normals.element(0) == positions.element(0) + 12);
+
+			// de-interleaved only when copied
+			auto packed = positions.copy();
+			REQUIRE(packed.size() == 36);
+
+			float position[9];
+			std::memcpy(position, packed.data(), sizeof(position));
+			REQUIRE(position[3] == 1.0f);
+			REQUIRE(position[7] == 1.0f);
+
+			// the bounds were left out, so they come from the strided positions
+			auto &bounds = registry.get<remus::BoundingBox>(entity);
+			REQUIRE(bounds.max.x == 1.0f);
+			REQUIRE(bounds.max.y == 1.0f);
+			REQUIRE(bounds.max.z == 0.0f);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Accessors out of the bounds of their buffer view are not loaded", "[loaders]")
+{
+	const std::string positions = R"({"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]})";
+	const std::string indices   = R"({"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"})";
+
+	struct Case
+	{
+		std::string from;
+		std::string to;
+		bool        indices;
+	};
+
+	const Case cases[] = {
+	    // a count whose size wraps around to fit the buffer
+	    {positions, R"({"bufferView": 0, "componentType": 5126, "count": 4611686018427387905, "type": "VEC3"})", false},
+	    // an offset whose sum with the view offset wraps around to the start of the buffer
+	    {indices, R"({"bufferView": 1, "byteOffset": 18446744073709551580, "componentType": 5123, "count": 3, "type": "SCALAR"})", true},
+	    // within the buffer, but running into the indices after the view
+	    {positions, R"({"bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3"})", false},
+	    {indices, R"({"bufferView": 1, "byteOffset": 2, "componentType": 5123, "count": 3, "type": "SCALAR"})", true}};
+
+	auto path = std::filesystem::temp_directory_path() / "remus_out_of_bounds.glb";
+
+	for (auto &test : cases)
+	{
+		auto json = triangle_json(R"({"byteLength": 114})");
+		json.replace(json.find(test.from), test.from.size(), test.to);
+
+		auto glb = make_glb(json, triangle_buffer());
+		write_file(path, glb.data(), glb.size());
+
+		remus::SceneGraph scene_graph;
+		remus::GLtfLoader gltf_loader;
+		REQUIRE(gltf_loader.load(path.string(), scene_graph).is_valid());
+
+		auto &registry = scene_graph.registry();
+		for (auto entity : registry.view<remus::StaticMeshPtr>())
+		{
+			auto &mesh = *registry.get<remus::StaticMeshPtr>(entity);
+			REQUIRE(mesh.indices.empty() == test.indices);
+			REQUIRE(mesh.attributes.at(remus::AttributeType::POSITION).empty() != test.indices);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file on a thread pool", "[loaders]")
+{
+	// one mesh of two primitives, each with its own material
+	auto json = std::string(R"({"asset": {"version": "2.0"},
+		"scenes": [{"nodes": [0]}],
+		"nodes": [{"name": "node", "mesh": 0}],
+		"meshes": [{"name": "mesh", "primitives": [
+			{"attributes": {"POSITION": 0}, "indices": 1, "material": 0},
+			{"attributes": {"POSITION": 0}, "indices": 1, "material": 1}]}],
+		"materials": [
+			{"pbrMetallicRoughness": {"baseColorTexture": {"index": 0}}},
+			{"pbrMetallicRoughness": {"baseColorFactor": [0, 1, 0, 1]}, "emissiveFactor": [1, 0, 0]}],
+		"textures": [{"source": 0}],
+		"images": [{"bufferView": 2, "mimeType": "image/png"}],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]},
+			{"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 36},
+			{"buffer": 0, "byteOffset": 36, "byteLength": 6},
+			{"buffer": 0, "byteOffset": 44, "byteLength": 70}],
+		"buffers": [{"byteLength": 114}]})");
+
+	auto path = std::filesystem::temp_directory_path() / "remus_primitives.glb";
+	auto glb  = make_glb(json, triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	remus::GLtfLoader gltf_loader;
+
+	SECTION("calling thread")
+	{
+	}
+
+	SECTION("thread pool")
+	{
+		gltf_loader.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+	}
+
+	{
+		remus::SceneGraph scene_graph;
+		REQUIRE(gltf_loader.load(path.string(), scene_graph).is_valid());
+
+		auto &registry = scene_graph.registry();
+
+		// every primitive is a child node holding its own material
+		size_t primitive_count = 0;
+		for (auto entity : registry.view<remus::StaticMeshPtr>())
+		{
+			auto  name     = remus::SceneNodeRef(scene_graph, entity).get_name();
+			auto &material = *registry.get<remus::PBRMaterialPtr>(entity);
+			REQUIRE(registry.all_of<remus::BoundingBox>(entity));
+
+			if (name == "node_mesh_primitive_0")
+			{
+				REQUIRE(material.base_color_texture);
+				REQUIRE(material.base_color_texture->data[0] == 255);
+			}
+			else
+			{
+				REQUIRE(name == "node_mesh_primitive_1");
+				REQUIRE(material.base_color_texture == nullptr);
+				REQUIRE(material.base_color_factor.y == 1.0f);
+				REQUIRE(material.emissive_factor.x == 1.0f);
+			}
+
+			primitive_count++;
+		}
+		REQUIRE(primitive_count == 2);
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Unsupported attributes and topologies are skipped on a thread pool", "[loaders]")
+{
+	// two meshes, so that they are built on the pool, a fan is valid glTF but has no PrimitiveTopology
+	auto json = triangle_json(R"({"byteLength": 114})");
+	auto from = std::string(R"("attributes": {"POSITION": 0}, "indices": 1, "material": 0}]}])");
+	json.replace(json.find(from), from.size(), R"("attributes": {"POSITION": 0, "TEXCOORD_2": 0, "COLOR_1": 0}, "indices": 1, "material": 0}]},
+		{"name": "fan", "primitives": [{"attributes": {"POSITION": 0}, "mode": 6}]}])");
+
+	auto path = std::filesystem::temp_directory_path() / "remus_unsupported.glb";
+	auto glb  = make_glb(json, triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	{
+		remus::SceneGraph scene_graph;
+		remus::GLtfLoader gltf_loader;
+		gltf_loader.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+		REQUIRE(gltf_loader.load(path.string(), scene_graph).is_valid());
+		require_triangle(scene_graph);
+
+		auto &registry = scene_graph.registry();
+		for (auto entity : registry.view<remus::StaticMeshPtr>())
+		{
+			REQUIRE(registry.get<remus::StaticMeshPtr>(entity)->attributes.size() == 1);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Nodes share the meshes and materials they reference", "[loaders]")
+{
+	// three nodes instance the triangle, the last two primitives of the second mesh use the same material
+	auto json = std::string(R"({"asset": {"version": "2.0"},
+		"scenes": [{"nodes": [0, 1, 2, 3]}],
+		"nodes": [{"mesh": 0}, {"mesh": 0}, {"mesh": 0}, {"name": "node", "mesh": 1}],
+		"meshes": [
+			{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1, "material": 0}]},
+			{"name": "mesh", "primitives": [
+				{"attributes": {"POSITION": 0}, "indices": 1, "material": 0},
+				{"attributes": {"POSITION": 0}, "indices": 1, "material": 0}]}],
+		"materials": [{"pbrMetallicRoughness": {"baseColorTexture": {"index": 0}}}],
+		"textures": [{"source": 0}],
+		"images": [{"bufferView": 2, "mimeType": "image/png"}],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]},
+			{"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 36},
+			{"buffer": 0, "byteOffset": 36, "byteLength": 6},
+			{"buffer": 0, "byteOffset": 44, "byteLength": 70}],
+		"buffers": [{"byteLength": 114}]})");
+
+	auto path = std::filesystem::temp_directory_path() / "remus_instances.glb";
+	auto glb  = make_glb(json, triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	{
+		remus::SceneGraph scene_graph;
+		REQUIRE(remus::GLtfLoader{}.load(path.string(), scene_graph).is_valid());
+
+		auto &registry = scene_graph.registry();
+
+		std::vector<remus::StaticMeshPtr>  instances;
+		std::vector<remus::StaticMeshPtr>  primitives;
+		std::vector<remus::PBRMaterialPtr> materials;
+		for (auto entity : registry.view<remus::StaticMeshPtr>())
+		{
+			auto &mesh = registry.get<remus::StaticMeshPtr>(entity);
+			if (remus::SceneNodeRef(scene_graph, entity).get_name().empty())
+			{
+				instances.push_back(mesh);
+			}
+			else
+			{
+				primitives.push_back(mesh);
+			}
+			materials.push_back(registry.get<remus::PBRMaterialPtr>(entity));
+		}
+
+		// one mesh per glTF mesh primitive, however many nodes use it
+		REQUIRE(instances.size() == 3);
+		REQUIRE(instances[0] == instances[1]);
+		REQUIRE(instances[0] == instances[2]);
+
+		REQUIRE(primitives.size() == 2);
+		REQUIRE(primitives[0] != primitives[1]);
+		REQUIRE(primitives[0] != instances[0]);
+
+		// one material per glTF material
+		REQUIRE(materials.size() == 5);
+		for (auto &material : materials)
+		{
+			REQUIRE(material == materials[0]);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Load a glTF file asynchronously", "[loaders]")
+{
+	auto path = std::filesystem::temp_directory_path() / "remus_async.glb";
+	auto glb  = make_glb(triangle_json(R"({"byteLength": 114})"), triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	remus::Channel<remus::GltfLoadEvent> channel;
+	auto                                 receiver = channel.receiver();
+
+	remus::GLtfLoader gltf_loader;
+
+	SECTION("calling thread")
+	{
+	}
+
+	SECTION("thread pool")
+	{
+		gltf_loader.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+	}
+
+	{
+		remus::SceneGraph scene_graph;
+
+		auto load = gltf_loader.load_async(path.string(), channel.sender());
+		load.wait();
+		REQUIRE(load.ready());
+		REQUIRE_FALSE(load.failed());
+
+		// nothing is added to the scene graph until it is committed
+		auto meshes = scene_graph.registry().view<remus::StaticMeshPtr>();
+		REQUIRE(meshes.begin() == meshes.end());
+		REQUIRE_FALSE(load.root().is_valid());
+
+		// without a budget a node is added per call, the triangle is a node and a scene
+		size_t commit_count = 1;
+		while (!load.commit(scene_graph, std::chrono::nanoseconds(0)))
+		{
+			commit_count++;
+		}
+		REQUIRE(commit_count == 3);
+		REQUIRE(load.root().is_valid());
+		REQUIRE(load.root().get_name() == "scene");
+		require_triangle(scene_graph);
+
+		// the stages are reported in order
+		std::vector<remus::GltfLoadStage> stages;
+		remus::GltfLoadEvent              event;
+		while (receiver->next(&event))
+		{
+			REQUIRE(event.path == path.string());
+			REQUIRE(event.completed <= event.total);
+			if (stages.empty() || stages.back() != event.stage)
+			{
+				stages.push_back(event.stage);
+			}
+		}
+		REQUIRE(stages == std::vector<remus::GltfLoadStage>{remus::GltfLoadStage::Parsing, remus::GltfLoadStage::DecodingImages,
+		                                                     remus::GltfLoadStage::BuildingMaterials, remus::GltfLoadStage::BuildingMeshes,
+		                                                     remus::GltfLoadStage::Ready, remus::GltfLoadStage::Committing, remus::GltfLoadStage::Done});
+	}
+
+	std::filesystem::remove(path);
+
+	// a missing file fails in the background
+	auto load = gltf_loader.load_async(path.string(), channel.sender());
+	load.wait();
+	REQUIRE(load.failed());
+
+	remus::SceneGraph scene_graph;
+	REQUIRE(load.commit(scene_graph, std::chrono::milliseconds(1)));
+	REQUIRE_FALSE(load.root().is_valid());
+
+	remus::GltfLoadEvent event;
+	REQUIRE(receiver->drain(&event));
+	REQUIRE(event.stage == remus::GltfLoadStage::Failed);
+}
+
+TEST_CASE("A glTF file throwing in the background fails to load", "[loaders]")
+{
+	auto path = std::filesystem::temp_directory_path() / "remus_async_throw.glb";
+	auto glb  = make_glb(triangle_json(R"({"byteLength": 114})"), triangle_buffer());
+	write_file(path, glb.data(), glb.size());
+
+	remus::GLtfLoader gltf_loader;
+	bool              plain_string = false;
+
+	SECTION("calling thread")
+	{
+		SECTION("exception")
+		{
+		}
+
+		SECTION("LOG_ASSERT")
+		{
+			plain_string = true;
+		}
+	}
+
+	SECTION("thread pool")
+	{
+		gltf_loader.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+
+		SECTION("exception")
+		{
+		}
+
+		SECTION("LOG_ASSERT")
+		{
+			plain_string = true;
+		}
+	}
+
+	// a receiver throwing once a mesh is built stands in for any error in the background, on a pool it throws inside parallel_for
+	remus::Channel<remus::GltfLoadEvent> channel;
+	auto                                 receiver = channel.coalescing_receiver([plain_string](const remus::GltfLoadEvent &event) {
+		if (event.stage == remus::GltfLoadStage::BuildingMeshes && event.completed == 1)
+		{
+			LOG_ASSERT(plain_string, "receiver failed");
+			throw std::runtime_error("receiver failed");
+		}
+		return static_cast<size_t>(event.stage);
+	});
+
+	auto load = gltf_loader.load_async(path.string(), channel.sender());
+	load.wait();
+	REQUIRE(load.failed());
+
+	// the half built scene is never committed, however often commit is called
+	remus::SceneGraph scene_graph;
+	REQUIRE(load.commit(scene_graph, std::chrono::milliseconds(1)));
+	REQUIRE(load.commit(scene_graph, std::chrono::milliseconds(1)));
+	REQUIRE_FALSE(load.root().is_valid());
+
+	auto meshes = scene_graph.registry().view<remus::StaticMeshPtr>();
+	REQUIRE(meshes.begin() == meshes.end());
+
+	std::vector<remus::GltfLoadEvent> events;
+	receiver->drain_into(events);
+	REQUIRE_FALSE(events.empty());
+	REQUIRE(events.back().stage == remus::GltfLoadStage::Failed);
+
+	std::filesystem::remove(path);
+}
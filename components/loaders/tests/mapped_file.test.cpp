@@ -0,0 +1,48 @@
+#include <loaders/mapped_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Map a file", "[loaders]")
+{
+	auto path = std::filesystem::temp_directory_path() / "remus_mapped_file.txt";
+
+	const std::string contents = "mapped file contents";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << contents;
+	}
+
+	{
+		remus::MappedFile file(path.string());
+		REQUIRE(file.is_open());
+		REQUIRE(file.size() == contents.size());
+		REQUIRE(std::memcmp(file.data(), contents.data(), contents.size()) == 0);
+
+		// the mapping moves with the object
+		remus::MappedFile moved = std::move(file);
+		REQUIRE(moved.is_open());
+		REQUIRE(moved.size() == contents.size());
+		REQUIRE(file.is_open() == false);
+		REQUIRE(file.data() == nullptr);
+	}
+
+	// an empty file is open with no data
+	{
+		std::ofstream truncate(path, std::ios::binary | std::ios::trunc);
+	}
+	{
+		remus::MappedFile empty(path.string());
+		REQUIRE(empty.is_open());
+		REQUIRE(empty.size() == 0);
+	}
+
+	std::filesystem::remove(path);
+
+	remus::MappedFile missing(path.string());
+	REQUIRE(missing.is_open() == false);
+}
@@ -0,0 +1,86 @@
+#include <scene_graph/scene_graph.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Query the BVH against a brute force search", "[scene_graph][benchmark]")
+{
+	for (size_t mesh_count : {100000, 500000})
+	{
+		remus::SceneGraph scene_graph;
+
+		std::mt19937                          rng(5);
+		std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+		remus::BoundingBox box;
+		box.min = glm::vec3(-1.0f);
+		box.max = glm::vec3(1.0f);
+
+		for (size_t i = 0; i < mesh_count; ++i)
+		{
+			auto node                    = scene_graph.create_node();
+			node.transform().rotation    = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			node.transform().translation = glm::vec3(position(rng), position(rng), position(rng));
+			node.add_component(box);
+		}
+
+		scene_graph.update(0.0f);
+
+		auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+		auto view       = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		auto frustum    = remus::Frustum::from_matrix(projection * view);
+		auto ray        = remus::Ray(glm::vec3(-1000.0f, 0.0f, 0.0f), glm::normalize(glm::vec3(1.0f, 0.1f, 0.05f)));
+
+		auto &registry   = scene_graph.registry();
+		auto  prefix     = std::to_string(mesh_count / 1000) + "k meshes, ";
+		auto  boxes_view = registry.view<remus::WorldBoundingBox>();
+
+		std::vector<entt::entity>  visible;
+		std::vector<remus::RayHit> hits;
+
+		BENCHMARK(prefix + "frustum, brute force")
+		{
+			visible.clear();
+			for (auto entity : boxes_view)
+			{
+				if (frustum.classify(boxes_view.get<remus::WorldBoundingBox>(entity).box) != remus::Frustum::Result::Outside)
+				{
+					visible.push_back(entity);
+				}
+			}
+			return visible.size();
+		};
+
+		BENCHMARK(prefix + "frustum, BVH")
+		{
+			visible.clear();
+			scene_graph.query_frustum(frustum, visible);
+			return visible.size();
+		};
+
+		BENCHMARK(prefix + "ray, brute force")
+		{
+			hits.clear();
+			for (auto entity : boxes_view)
+			{
+				float distance;
+				if (ray.intersects(boxes_view.get<remus::WorldBoundingBox>(entity).box, distance))
+				{
+					hits.push_back({entity, distance});
+				}
+			}
+			std::sort(hits.begin(), hits.end(), [](const remus::RayHit &a, const remus::RayHit &b) { return a.distance < b.distance; });
+			return hits.size();
+		};
+
+		BENCHMARK(prefix + "ray, BVH")
+		{
+			hits.clear();
+			scene_graph.query_ray(ray, hits);
+			return hits.size();
+		};
+	}
+}
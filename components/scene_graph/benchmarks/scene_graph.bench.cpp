@@ -0,0 +1,319 @@
+#include <scene_graph/hierarchy.hpp>
+#include <scene_graph/scene_graph.hpp>
+#include <scene_graph/transform_kernels.hpp>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+// build a scene of mostly static nodes, each node has up to branching_factor children
+std::vector<remus::SceneNodeRef> create_scene(remus::SceneGraph &scene_graph, size_t node_count, size_t branching_factor)
+{
+	std::vector<remus::SceneNodeRef> nodes;
+	nodes.reserve(node_count);
+
+	for (size_t i = 0; i < node_count; ++i)
+	{
+		auto node = scene_graph.create_node();
+		if (i > 0)
+		{
+			node.set_parent(nodes[(i - 1) / branching_factor]);
+		}
+		nodes.push_back(node);
+	}
+
+	return nodes;
+}
+}        // namespace
+
+TEST_CASE("Update world matrices against the fraction of moved nodes", "[scene_graph][benchmark]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto nodes = create_scene(scene_graph, 200000, 8);
+
+	// settle the initial world matrices
+	scene_graph.update(0.0f);
+
+	for (size_t permille : {0, 1, 10, 100, 1000})
+	{
+		size_t moved_count = nodes.size() * permille / 1000;
+		size_t stride      = moved_count > 0 ? nodes.size() / moved_count : 0;
+
+		BENCHMARK("200k nodes, " + std::to_string(permille / 10.0f).substr(0, 5) + "% moved")
+		{
+			// walk from the back so that small fractions move leaves rather than whole subtrees
+			for (size_t i = 0; i < moved_count; ++i)
+			{
+				nodes[nodes.size() - 1 - i * stride].transform().translation.x += 1.0f;
+			}
+
+			scene_graph.update(0.0f);
+		};
+	}
+}
+
+TEST_CASE("Access components through node handles", "[scene_graph][benchmark]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto nodes = create_scene(scene_graph, 100000, 8);
+	scene_graph.update(0.0f);
+
+	BENCHMARK("100k get_component<WorldMatrix>")
+	{
+		float sum = 0.0f;
+		for (auto &node : nodes)
+		{
+			sum += node.get_component<remus::WorldMatrix>().matrix[3].x;
+		}
+		return sum;
+	};
+
+	BENCHMARK("100k transform()")
+	{
+		for (auto &node : nodes)
+		{
+			node.transform().translation.y += 1.0f;
+		}
+		return nodes.size();
+	};
+}
+
+TEST_CASE("Stream a level in and out", "[scene_graph][benchmark]")
+{
+	remus::SceneGraph scene_graph;
+
+	// a resident scene which every removal has to compact around
+	auto resident = create_scene(scene_graph, 50000, 8);
+
+	constexpr size_t level_size = 2000;
+
+	BENCHMARK("2k nodes, destroy_subtree")
+	{
+		auto level = create_scene(scene_graph, level_size, 8);
+		level.front().set_parent(resident.front());
+		scene_graph.update(0.0f);
+
+		scene_graph.destroy_subtree(level.front());
+		return level.size();
+	};
+
+	BENCHMARK("2k nodes, destroy_node one by one")
+	{
+		auto level = create_scene(scene_graph, level_size, 8);
+		level.front().set_parent(resident.front());
+		scene_graph.update(0.0f);
+
+		for (auto &node : level)
+		{
+			scene_graph.destroy_node(node);
+		}
+		return level.size();
+	};
+}
+
+TEST_CASE("Parent a flat scene to a root created afterwards", "[scene_graph][benchmark]")
+{
+	// the layout produced by the glTF loader, scene roots are created after all of their nodes
+	for (size_t node_count : {1000, 10000, 100000})
+	{
+		BENCHMARK(std::to_string(node_count) + " siblings, set_parent one by one")
+		{
+			remus::SceneGraph scene_graph;
+
+			std::vector<remus::SceneNodeRef> nodes;
+			for (size_t i = 0; i < node_count; ++i)
+			{
+				nodes.push_back(scene_graph.create_node());
+			}
+
+			auto root = scene_graph.create_node();
+			for (auto &node : nodes)
+			{
+				node.set_parent(root);
+			}
+
+			scene_graph.update(0.0f);
+			return nodes.size();
+		};
+
+		BENCHMARK(std::to_string(node_count) + " siblings, batched set_parent")
+		{
+			remus::SceneGraph scene_graph;
+
+			std::vector<remus::SceneNodeRef> nodes;
+			for (size_t i = 0; i < node_count; ++i)
+			{
+				nodes.push_back(scene_graph.create_node());
+			}
+
+			auto root = scene_graph.create_node();
+			scene_graph.set_parent(nodes.data(), nodes.size(), root);
+
+			scene_graph.update(0.0f);
+			return nodes.size();
+		};
+	}
+}
+
+TEST_CASE("Propagate world matrices across threads", "[scene_graph][benchmark]")
+{
+	// powers of two up to, and including, the hardware thread count
+	std::vector<size_t> thread_counts;
+	for (size_t thread_count = 1; thread_count < std::thread::hardware_concurrency(); thread_count *= 2)
+	{
+		thread_counts.push_back(thread_count);
+	}
+	thread_counts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+
+	for (size_t node_count : {10000, 100000, 1000000})
+	{
+		entt::registry   registry;
+		remus::Hierarchy hierarchy(registry);
+
+		for (size_t i = 0; i < node_count; ++i)
+		{
+			auto id = hierarchy.create(registry.create());
+			if (i > 0)
+			{
+				hierarchy.set_parent(id, static_cast<remus::Hierarchy::Id>((i - 1) / 8));
+			}
+		}
+
+		hierarchy.update();
+
+		for (size_t thread_count : thread_counts)
+		{
+			remus::ThreadPool thread_pool(thread_count - 1);
+
+			BENCHMARK(std::to_string(node_count) + " nodes, " + std::to_string(thread_count) + " threads")
+			{
+				// the root is dirty so every node is recomputed
+				hierarchy.mark_dirty(0);
+				hierarchy.update(&thread_pool);
+			};
+		}
+	}
+}
+
+TEST_CASE("Registry traffic of a frame where every node moved", "[scene_graph][benchmark]")
+{
+	constexpr size_t count = 100000;
+
+	entt::registry                registry;
+	std::vector<entt::entity>     entities(count);
+	std::vector<remus::Transform> locals(count);
+	std::vector<glm::mat4>        worlds(count, glm::mat4(1.0f));
+	for (auto &entity : entities)
+	{
+		entity = registry.create();
+		registry.emplace<remus::Transform>(entity);
+		registry.emplace<remus::WorldMatrix>(entity, glm::mat4(1.0f));
+	}
+
+	// a listener such as the one held by the hierarchy, every replace pays for the signal
+	size_t notifications = 0;
+	struct Listener
+	{
+		size_t *notifications;
+
+		void on_update(entt::registry &, entt::entity)
+		{
+			(*notifications)++;
+		}
+	} listener{&notifications};
+	registry.on_update<remus::Transform>().connect<&Listener::on_update>(listener);
+	registry.on_update<remus::WorldMatrix>().connect<&Listener::on_update>(listener);
+
+	BENCHMARK("emplace_or_replace Transform and WorldMatrix copies")
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			registry.emplace_or_replace<remus::WorldMatrix>(entities[i], worlds[i]);
+			registry.emplace_or_replace<remus::Transform>(entities[i], locals[i]);
+		}
+		return notifications;
+	};
+
+	BENCHMARK("write WorldMatrix in place")
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			registry.get<remus::WorldMatrix>(entities[i]).matrix = worlds[i];
+		}
+		return notifications;
+	};
+
+	registry.on_update<remus::Transform>().disconnect<&Listener::on_update>(listener);
+	registry.on_update<remus::WorldMatrix>().disconnect<&Listener::on_update>(listener);
+}
+
+TEST_CASE("Compose world matrices with the transform kernels", "[scene_graph][benchmark]")
+{
+	constexpr size_t count = 100000;
+
+	std::vector<remus::Transform> transforms(count);
+	std::vector<float>            values[10];
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto &transform       = transforms[i];
+		transform.translation = glm::vec3(static_cast<float>(i), 1.0f, 2.0f);
+		transform.rotation    = glm::normalize(glm::quat(1.0f, 0.1f * static_cast<float>(i % 7), 0.2f, 0.3f));
+		transform.scale       = glm::vec3(1.0f, 2.0f, 3.0f);
+
+		float components[10] = {transform.translation.x, transform.translation.y, transform.translation.z,
+		                        transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w,
+		                        transform.scale.x, transform.scale.y, transform.scale.z};
+		for (size_t component = 0; component < 10; ++component)
+		{
+			values[component].push_back(components[component]);
+		}
+	}
+
+	remus::TransformBatch batch{{values[0].data(), values[1].data(), values[2].data()},
+	                            {values[3].data(), values[4].data(), values[5].data(), values[6].data()},
+	                            {values[7].data(), values[8].data(), values[9].data()}};
+
+	glm::mat4                      parent(1.0f);
+	std::vector<glm::mat4>         worlds(count);
+	std::vector<const glm::mat4 *> parent_pointers(count, &parent);
+	std::vector<glm::mat4 *>       world_pointers(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		world_pointers[i] = &worlds[i];
+	}
+
+	BENCHMARK("glm translate * mat4_cast * scale")
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto &transform = transforms[i];
+
+			glm::mat4 matrix(1.0f);
+			matrix = glm::translate(matrix, transform.translation);
+			matrix *= glm::mat4_cast(transform.rotation);
+			matrix = glm::scale(matrix, transform.scale);
+
+			worlds[i] = parent * matrix;
+		}
+		return worlds.back();
+	};
+
+	const char *kernel_names[] = {"scalar", "SSE2", "AVX2"};
+
+	for (auto kernel : {remus::TransformKernel::Scalar, remus::TransformKernel::SSE2, remus::TransformKernel::AVX2})
+	{
+		if (!remus::is_supported(kernel))
+		{
+			continue;
+		}
+
+		BENCHMARK(std::string("kernel ") + kernel_names[static_cast<int>(kernel)])
+		{
+			remus::compose_world_matrices(kernel, batch, parent_pointers.data(), world_pointers.data(), count);
+			return worlds.back();
+		};
+	}
+}
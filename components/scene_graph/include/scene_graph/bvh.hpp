@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "components/bounding_box.hpp"
+
+namespace remus
+{
+/* The six planes of a view frustum, normals point inwards.
+ * Built from a projection * view matrix with clip space depth in [-1, 1].
+ * With a [0, 1] depth range the near plane is placed behind the camera, which keeps the test conservative.
+ */
+struct Frustum
+{
+	enum class Result
+	{
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	glm::vec4 planes[6];
+
+	static Frustum from_matrix(const glm::mat4 &view_projection)
+	{
+		// rows of the matrix, glm matrices are indexed by column
+		glm::vec4 rows[4];
+		for (int row = 0; row < 4; ++row)
+		{
+			rows[row] = glm::vec4(view_projection[0][row], view_projection[1][row], view_projection[2][row], view_projection[3][row]);
+		}
+
+		Frustum frustum;
+		frustum.planes[0] = rows[3] + rows[0];        // left
+		frustum.planes[1] = rows[3] - rows[0];        // right
+		frustum.planes[2] = rows[3] + rows[1];        // bottom
+		frustum.planes[3] = rows[3] - rows[1];        // top
+		frustum.planes[4] = rows[3] + rows[2];        // near
+		frustum.planes[5] = rows[3] - rows[2];        // far
+
+		for (auto &plane : frustum.planes)
+		{
+			plane = plane / glm::length(glm::vec3(plane));
+		}
+
+		return frustum;
+	}
+
+	Result classify(const BoundingBox &box) const
+	{
+		glm::vec3 center = box.center();
+		glm::vec3 extent = box.extent();
+
+		Result result = Result::Inside;
+		for (auto &plane : planes)
+		{
+			glm::vec3 normal   = glm::vec3(plane);
+			float     distance = glm::dot(normal, center) + plane.w;
+			float     radius   = glm::dot(extent, glm::abs(normal));
+
+			if (distance + radius < 0.0f)
+			{
+				return Result::Outside;
+			}
+			if (distance - radius < 0.0f)
+			{
+				result = Result::Intersects;
+			}
+		}
+		return result;
+	}
+};
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction;
+	float     max_distance{std::numeric_limits<float>::max()};
+
+	Ray(const glm::vec3 &origin, const glm::vec3 &direction, float max_distance = std::numeric_limits<float>::max()) :
+	    origin(origin),
+	    direction(direction),
+	    max_distance(max_distance),
+	    inverse_direction(1.0f / direction)
+	{}
+
+	// slab test, distance is set to where the ray enters the box or 0 when it starts inside
+	bool intersects(const BoundingBox &box, float &distance) const
+	{
+		glm::vec3 t0 = (box.min - origin) * inverse_direction;
+		glm::vec3 t1 = (box.max - origin) * inverse_direction;
+
+		glm::vec3 near = glm::min(t0, t1);
+		glm::vec3 far  = glm::max(t0, t1);
+
+		float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+		float exit  = std::min(std::min(far.x, far.y), std::min(far.z, max_distance));
+
+		distance = enter;
+		return enter <= exit;
+	}
+
+  private:
+	glm::vec3 inverse_direction;
+};
+
+struct RayHit
+{
+	entt::entity entity;
+	float        distance;
+};
+
+/* A dynamic bounding volume hierarchy of entities.
+ * Leaves store a fattened copy of each box, so small movements do not change the tree.
+ * Insertion picks the sibling with the lowest surface area cost and the tree is kept balanced with rotations.
+ * Queries test the exact boxes at the leaves so their results match a brute force search.
+ */
+class DynamicBVH
+{
+  public:
+	using Proxy = uint32_t;
+
+	static constexpr Proxy null_proxy = std::numeric_limits<uint32_t>::max();
+
+	// margin added on every side of the boxes stored in the tree
+	explicit DynamicBVH(float margin = 0.1f) :
+	    margin(margin)
+	{}
+
+	Proxy create_proxy(const BoundingBox &box, entt::entity entity);
+
+	void destroy_proxy(Proxy proxy);
+
+	// update the box of a proxy, returns true if it left its fattened box and was reinserted
+	bool move_proxy(Proxy proxy, const BoundingBox &box);
+
+	const BoundingBox &get_box(Proxy proxy) const
+	{
+		return nodes[proxy].exact;
+	}
+
+	// number of proxies
+	size_t size() const
+	{
+		return proxy_count;
+	}
+
+	// height of the tree, 0 when empty
+	int32_t height() const
+	{
+		return root == null_proxy ? 0 : nodes[root].height + 1;
+	}
+
+	// call func(entity) for every proxy whose box intersects the frustum
+	template <typename Func>
+	void query(const Frustum &frustum, Func &&func) const;
+
+	// call func(entity) for every proxy whose box overlaps the box
+	template <typename Func>
+	void query(const BoundingBox &box, Func &&func) const;
+
+	// call func(entity, distance) for every proxy whose box is hit by the ray, in no particular order
+	template <typename Func>
+	void ray_cast(const Ray &ray, Func &&func) const;
+
+  private:
+	struct Node
+	{
+		BoundingBox  box;          // fattened for leaves, the union of the children otherwise
+		BoundingBox  exact;        // leaves only
+		uint32_t     parent{null_proxy};
+		uint32_t     children[2]{null_proxy, null_proxy};
+		int32_t      height{0};        // 0 for leaves, -1 for free nodes
+		entt::entity entity{entt::null};
+
+		bool is_leaf() const
+		{
+			return children[0] == null_proxy;
+		}
+	};
+
+	float margin;
+
+	std::vector<Node>     nodes;
+	std::vector<uint32_t> free_nodes;
+	uint32_t              root{null_proxy};
+	size_t                proxy_count{0};
+
+	// traversal stack, queries are const but may run on one thread at a time
+	mutable std::vector<uint32_t> stack;
+
+	uint32_t allocate_node();
+	void     free_node(uint32_t node);
+
+	void insert_leaf(uint32_t leaf);
+	void remove_leaf(uint32_t leaf);
+
+	// refit the ancestors of node, rotating them where the subtrees are unbalanced
+	void refit(uint32_t node);
+
+	// rotate node if one of its subtrees is higher than the other by more than one, returns the root of the subtree
+	uint32_t balance(uint32_t node);
+
+	// call func(node) for every leaf below node
+	template <typename Func>
+	void for_each_leaf(uint32_t node, Func &&func) const;
+};
+
+template <typename Func>
+void DynamicBVH::for_each_leaf(uint32_t node, Func &&func) const
+{
+	auto base = stack.size();
+	stack.push_back(node);
+	while (stack.size() > base)
+	{
+		auto index = stack.back();
+		stack.pop_back();
+
+		auto &current = nodes[index];
+		if (current.is_leaf())
+		{
+			func(current);
+		}
+		else
+		{
+			stack.push_back(current.children[0]);
+			stack.push_back(current.children[1]);
+		}
+	}
+}
+
+template <typename Func>
+void DynamicBVH::query(const Frustum &frustum, Func &&func) const
+{
+	if (root == null_proxy)
+	{
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		auto index = stack.back();
+		stack.pop_back();
+
+		auto &node = nodes[index];
+		if (node.is_leaf())
+		{
+			if (frustum.classify(node.exact) != Frustum::Result::Outside)
+			{
+				func(node.entity);
+			}
+			continue;
+		}
+
+		auto result = frustum.classify(node.box);
+		if (result == Frustum::Result::Inside)
+		{
+			// the exact boxes are inside the fattened ones, everything below is visible
+			for_each_leaf(index, [&](const Node &leaf) { func(leaf.entity); });
+		}
+		else if (result == Frustum::Result::Intersects)
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+template <typename Func>
+void DynamicBVH::query(const BoundingBox &box, Func &&func) const
+{
+	if (root == null_proxy)
+	{
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		auto &node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.is_leaf())
+		{
+			if (node.exact.overlaps(box))
+			{
+				func(node.entity);
+			}
+		}
+		else if (node.box.overlaps(box))
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+template <typename Func>
+void DynamicBVH::ray_cast(const Ray &ray, Func &&func) const
+{
+	if (root == null_proxy)
+	{
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		auto &node = nodes[stack.back()];
+		stack.pop_back();
+
+		float distance;
+		if (node.is_leaf())
+		{
+			if (ray.intersects(node.exact, distance))
+			{
+				func(node.entity, distance);
+			}
+		}
+		else if (ray.intersects(node.box, distance))
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+}        // namespace remus
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <limits>
+
+#include <glm/glm.hpp>
+
+namespace remus
+{
+// Axis aligned box in the space of the node's mesh, an empty box has min > max
+struct BoundingBox
+{
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+	bool empty() const
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	void merge(const glm::vec3 &point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void merge(const BoundingBox &other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	bool contains(const BoundingBox &other) const
+	{
+		return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+	}
+
+	bool overlaps(const BoundingBox &other) const
+	{
+		return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+	}
+
+	glm::vec3 center() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	glm::vec3 extent() const
+	{
+		return (max - min) * 0.5f;
+	}
+
+	// surface area, the cost used to choose where boxes are inserted in the BVH
+	float area() const
+	{
+		glm::vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	// the box enclosing this box once transformed, the extent is projected onto the matrix axes
+	BoundingBox transformed(const glm::mat4 &matrix) const
+	{
+		glm::vec3 new_center = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+		glm::vec3 old_extent = extent();
+		glm::vec3 new_extent = glm::abs(glm::vec3(matrix[0])) * old_extent.x +
+		                       glm::abs(glm::vec3(matrix[1])) * old_extent.y +
+		                       glm::abs(glm::vec3(matrix[2])) * old_extent.z;
+
+		BoundingBox box;
+		box.min = new_center - new_extent;
+		box.max = new_center + new_extent;
+		return box;
+	}
+};
+
+// The BoundingBox of the node in world space, kept up to date by the scene graph alongside the WorldMatrix
+struct WorldBoundingBox
+{
+	BoundingBox box;
+};
+}        // namespace remus
@@ -30,4 +30,7 @@ struct PBRMaterial
 	ImagePtr  occlusion_texture{};
 	ImagePtr  emissive_texture{};
 };
+
+// nodes that use the same material share it
+using PBRMaterialPtr = std::shared_ptr<PBRMaterial>;
 };        // namespace remus
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -41,7 +44,79 @@ inline std::string to_string(AttributeType type)
 #undef CASE
 }
 
-using AttributesMap = std::unordered_map<AttributeType, std::vector<uint8_t>>;
+/* A strided view of count elements of element_size bytes, element i starts at i * stride bytes from the first.
+ * The bytes are not copied, data shares ownership of the buffer they live in, such as a mapped file, so views are cheap to copy
+ * and interleaved vertex data is viewed as it is. Copying or de-interleaving only happens when a consumer asks for it.
+ */
+struct AccessorView
+{
+	std::shared_ptr<const uint8_t> data;        // the first element, aliasing the buffer which owns it
+	size_t                         count{0};
+	size_t                         element_size{0};
+	size_t                         stride{0};
+
+	// a view owning bytes, count elements packed back to back
+	static AccessorView from_bytes(std::vector<uint8_t> bytes, size_t element_size)
+	{
+		auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+
+		AccessorView view;
+		view.data         = std::shared_ptr<const uint8_t>(owner, owner->data());
+		view.count        = element_size ? owner->size() / element_size : 0;
+		view.element_size = element_size;
+		view.stride       = element_size;
+		return view;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	// the elements follow each other without gaps
+	bool is_packed() const
+	{
+		return stride == element_size;
+	}
+
+	// the size of the elements packed
+	size_t size() const
+	{
+		return count * element_size;
+	}
+
+	const uint8_t *element(size_t index) const
+	{
+		return data.get() + index * stride;
+	}
+
+	// copy the elements to out, packed
+	void copy_to(uint8_t *out) const
+	{
+		if (is_packed())
+		{
+			std::memcpy(out, data.get(), size());
+			return;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::memcpy(out + i * element_size, element(i), element_size);
+		}
+	}
+
+	std::vector<uint8_t> copy() const
+	{
+		std::vector<uint8_t> out(size());
+		if (!out.empty())
+		{
+			copy_to(out.data());
+		}
+		return out;
+	}
+};
+
+using AttributesMap = std::unordered_map<AttributeType, AccessorView>;
 
 enum class PrimitiveTopology
 {
@@ -72,9 +147,12 @@ struct StaticMesh
 {
 	PrimitiveTopology topology;
 
-	size_t               indices_count;
-	std::vector<uint8_t> indices;
+	size_t       indices_count;
+	AccessorView indices;        // element_size is the size of an index
 
 	AttributesMap attributes;
 };
+
+// nodes that instance the same mesh share it
+using StaticMeshPtr = std::shared_ptr<StaticMesh>;
 }        // namespace remus
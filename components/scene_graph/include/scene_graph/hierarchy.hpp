@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <core/thread_pool.hpp>
+#include <entt/entt.hpp>
+
+#include "transform.hpp"
+
+namespace remus
+{
+/* Flat storage of the scene hierarchy.
+ * Nodes are kept in contiguous arrays sorted so that a parent is always stored before its children.
+ * World matrices can then be propagated in a single linear pass.
+ * Reparenting below a node stored later only records the link, the arrays are sorted again in one pass on the next update.
+ * A node is addressed by a stable id, its position in the arrays changes when it is reparented.
+ * Local transforms are not copied, they are read from the Transform component of the node's entity.
+ */
+class Hierarchy
+{
+  public:
+	using Id = uint32_t;
+
+	static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+	explicit Hierarchy(entt::registry &registry);
+	~Hierarchy();
+
+	Hierarchy(const Hierarchy &)            = delete;
+	Hierarchy(Hierarchy &&)                 = delete;
+	Hierarchy &operator=(const Hierarchy &) = delete;
+	Hierarchy &operator=(Hierarchy &&)      = delete;
+
+	// add a root node and emplace its Transform and WorldMatrix, new nodes start dirty, ids of destroyed nodes are reused
+	Id create(entt::entity entity);
+
+	// remove a node along with its Transform and WorldMatrix, its children are moved to its parent
+	void destroy(Id id);
+
+	// remove a node and all of its descendants in one pass, their entities are appended to destroyed
+	void destroy_subtree(Id id, std::vector<entt::entity> &destroyed);
+
+	// move a node and its descendants below a new parent, throws if the parent is one of its descendants
+	void set_parent(Id id, Id parent);
+
+	// move count nodes below the same parent, stops at the first node which would create a cycle and throws
+	void set_parent(const Id *ids, size_t count, Id parent);
+
+	// the parent id or npos for a root
+	Id get_parent(Id id) const;
+
+	// flag the node so that its world matrix, and those of its descendants, are recomputed on the next update
+	void mark_dirty(Id id);
+
+	// the Transform component of the node, replacing or patching it through the registry also marks the node dirty
+	Transform &local(Id id)
+	{
+		return registry->get<Transform>(entities[positions[id]]);
+	}
+
+	const glm::mat4 &world(Id id) const
+	{
+		return worlds[positions[id]];
+	}
+
+	/*
+	 * Recompute the world matrices of all dirty nodes and their descendants.
+	 * Nodes at the same depth below their first dirty ancestor are computed in batches by the transform kernel.
+	 * With a thread pool these batches run in parallel, the result is bit-identical to the serial path.
+	 * The WorldMatrix components of the recomputed nodes are written in place, no signals are emitted.
+	 * The positions of the nodes that were recomputed are available through updated() until the next update.
+	 */
+	void update(ThreadPool *thread_pool = nullptr);
+
+	const std::vector<uint32_t> &updated() const
+	{
+		return updated_positions;
+	}
+
+	size_t size() const
+	{
+		return ids.size();
+	}
+
+	entt::entity entity_at(uint32_t position) const
+	{
+		return entities[position];
+	}
+
+	// the position of the parent or npos for a root
+	uint32_t parent_at(uint32_t position) const
+	{
+		return parents[position];
+	}
+
+	const glm::mat4 &world_at(uint32_t position) const
+	{
+		return worlds[position];
+	}
+
+  private:
+	entt::registry *registry;
+
+	// indexed by position
+	std::vector<Id>           ids;
+	std::vector<entt::entity> entities;
+	std::vector<uint32_t>     parents;
+	std::vector<glm::mat4>    worlds;
+	std::vector<uint8_t>      dirty;
+
+	// indexed by id, npos for the ids in free_ids
+	std::vector<uint32_t> positions;
+	std::vector<Id>       free_ids;
+
+	// indexed by entity index, used to find the node of a Transform which was updated through the registry
+	std::vector<Id> entity_ids;
+
+	// lowest dirty position, everything before it is up to date
+	uint32_t first_dirty{npos};
+
+	// lowest position of a node whose parent is stored after it, npos when the arrays are sorted
+	uint32_t first_unsorted{npos};
+
+	std::vector<uint32_t> updated_positions;
+
+	// scratch used to group the updated positions by level, indexed by position
+	std::vector<uint32_t> levels;
+	std::vector<uint32_t> level_offsets;
+	std::vector<uint32_t> level_order;
+
+	void on_transform_update(entt::registry &registry, entt::entity entity);
+
+	// scratch used when removing or moving nodes, indexed by position relative to the first affected node
+	std::vector<uint8_t>      marked;
+	std::vector<uint32_t>     remap;
+	std::vector<entt::entity> removed_entities;
+	std::vector<uint32_t>     child_offsets;
+	std::vector<uint32_t>     child_list;
+	std::vector<uint32_t>     stack;
+
+	// gather the transforms of the given positions and run them through the transform kernel
+	void compute_worlds(const uint32_t *positions, size_t count);
+
+	// mark the subtree rooted at position, returns its size
+	uint32_t mark_subtree(uint32_t position);
+
+	// compact the arrays by dropping the marked nodes of [first, size), their entities are appended to removed_entities
+	void remove(uint32_t first);
+
+	// restore the parent before child order of [first_unsorted, size), subtrees are laid out depth first
+	void sort();
+};
+}        // namespace remus
@@ -1,188 +1,90 @@
 #pragma once
 
+#include <string>
+
 #include <entt/entt.hpp>
 
+#include "bvh.hpp"
+#include "hierarchy.hpp"
 #include "transform.hpp"
 
 namespace remus
 {
 class SceneGraph;
 
-class SceneNode
+// Per node data which is not a component, pooled by the scene graph and indexed by entity index
+struct SceneNode
 {
-  public:
-	friend class remus::SceneGraph;
-
-	SceneNode(entt::registry &registry) :
-	    entity(registry.create()),
-	    registry(&registry)
-	{}
-
-	~SceneNode() = default;
-
-	std::string name;
-
-	Transform transform;
-
-	template <typename T, typename... Args>
-	T &emplace_component(Args &&...args)
-	{
-		return registry->emplace_or_replace<T>(entity, std::forward<Args>(args)...);
-	}
-
-	template <typename T>
-	T &add_component(const T &component = {})
-	{
-		return registry->emplace_or_replace<T>(entity, component);
-	}
-
-	template <typename T>
-	T &get_component()
-	{
-		return registry->get<T>(entity);
-	}
-
-	template <typename T>
-	bool has_component()
-	{
-		return registry->all_of<T>(entity);
-	}
-
-	template <typename T>
-	void remove_component()
-	{
-		registry->remove<T>(entity);
-	}
-
-	void set_parent(SceneNode &node)
-	{
-		if (parent)
-		{
-			// remove this node from the parent's children
-			parent->children.erase(std::remove(parent->children.begin(), parent->children.end(), this), parent->children.end());
-		}
-
-		parent = &node;
-		node.children.push_back(this);
-	}
-
-  private:
-	entt::entity    entity;
-	entt::registry *registry;
-
-	SceneNode               *parent{nullptr};
-	std::vector<SceneNode *> children;
-
-	glm::mat4 get_world_matrix() const
-	{
-		if (parent)
-		{
-			return parent->get_world_matrix() * transform.get_matrix();
-		}
-		return transform.get_matrix();
-	}
+	std::string       name;
+	Hierarchy::Id     id{Hierarchy::npos};
+	DynamicBVH::Proxy proxy{DynamicBVH::null_proxy};        // set while the node has a BoundingBox
 };
 
+/* A handle to a node of a scene graph.
+ * The handle is the node's entity, whose version is bumped by the registry when the node is destroyed.
+ * Checking a handle compares the entity against the registry, there is no reference counting involved.
+ * Accessors throw if the node has been destroyed, the scene graph must outlive its handles.
+ */
 class SceneNodeRef
 {
   public:
+	friend class remus::SceneGraph;
+
 	SceneNodeRef() = default;
 
-	SceneNodeRef(std::weak_ptr<SceneNode> node) :
-	    node(node)
+	SceneNodeRef(SceneGraph &scene_graph, entt::entity entity) :
+	    scene_graph(&scene_graph),
+	    entity(entity)
 	{}
 
 	~SceneNodeRef() = default;
 
-	void set_name(const std::string &name) const
-	{
-		if (auto ptr = node.lock())
-		{
-			ptr->name = name;
-			return;
-		}
-		throw std::runtime_error("Node is expired");
-	}
+	void set_name(const std::string &name) const;
 
-	bool is_valid() const
-	{
-		return !node.expired();
-	}
+	const std::string &get_name() const;
+
+	bool is_valid() const;
 
-	Transform &transform()
+	entt::entity get_entity() const
 	{
-		if (auto ptr = node.lock())
-		{
-			return ptr->transform;
-		}
-		throw std::runtime_error("Node is expired");
+		return entity;
 	}
 
+	// the transform is assumed to be modified, do not hold on to the reference past the next update
+	Transform &transform();
+
 	template <typename T, typename... Args>
-	T &emplace_component(Args &&...args)
-	{
-		if (auto ptr = node.lock())
-		{
-			return ptr->emplace_component<T>(std::forward<Args>(args)...);
-		}
-		throw std::runtime_error("Node is expired");
-	}
+	T &emplace_component(Args &&...args);
 
 	template <typename T>
-	T &add_component(const T &component = {})
-	{
-		if (auto ptr = node.lock())
-		{
-			return ptr->add_component<T>(component);
-		}
-		throw std::runtime_error("Node is expired");
-	}
+	T &add_component(const T &component = {});
 
 	template <typename T>
-	T &get_component()
-	{
-		if (auto ptr = node.lock())
-		{
-			return ptr->get_component<T>();
-		}
-		throw std::runtime_error("Node is expired");
-	}
+	T &get_component();
 
 	template <typename T>
-	bool has_component()
-	{
-		if (auto ptr = node.lock())
-		{
-			return ptr->has_component<T>();
-		}
-		throw std::runtime_error("Node is expired");
-	}
+	bool has_component();
 
 	template <typename T>
-	void remove_component()
+	void remove_component();
+
+	void set_parent(SceneNodeRef &new_parent);
+
+	bool operator==(const SceneNodeRef &other) const
 	{
-		if (auto ptr = node.lock())
-		{
-			ptr->remove_component<T>();
-			return;
-		}
-		throw std::runtime_error("Node is expired");
+		return scene_graph == other.scene_graph && entity == other.entity;
 	}
 
-	void set_parent(SceneNodeRef &new_parent)
+	bool operator!=(const SceneNodeRef &other) const
 	{
-		auto ptr      = new_parent.node.lock();
-		auto this_ptr = node.lock();
-		if (ptr && this_ptr)
-		{
-			this_ptr->set_parent(*ptr);
-			return;
-		}
-
-		throw std::runtime_error("Node is expired");
+		return !(*this == other);
 	}
 
   private:
-	std::weak_ptr<SceneNode> node;
+	SceneGraph  *scene_graph{nullptr};
+	entt::entity entity{entt::null};
+
+	// the registry of the scene graph, throws if the node has been destroyed
+	entt::registry &checked_registry() const;
 };
 }        // namespace remus
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 #include <typeindex>
 #include <typeinfo>
 
+#include <core/thread_pool.hpp>
 #include <entt/entt.hpp>
 
+#include "bvh.hpp"
+#include "components/bounding_box.hpp"
 #include "node.hpp"
+#include "system.hpp"
+#include "system_scheduler.hpp"
 
 namespace remus
 {
@@ -14,29 +20,39 @@ class Node;
 class SceneGraph;
 using SceneGraphPtr = std::shared_ptr<SceneGraph>;
 
-// Perform a process on a set of entities held in the scene graph.
-class System
-{
-  public:
-	virtual ~System()                                                     = default;
-	virtual void update(entt::registry &registry, float delta_time) const = 0;
-};
-
 /* The scene graph is the root of the entity-component system.
  * It holds the registry and all the systems.
  * It is responsible for updating the systems.
  * It is responsible for creating nodes.
+ * Nodes with a BoundingBox are given a WorldBoundingBox and indexed in a BVH for visibility and picking queries.
  */
 class SceneGraph final
 {
   public:
 	friend class remus::Node;
+	friend class remus::SceneNodeRef;
 
-	SceneGraph()  = default;
-	~SceneGraph() = default;
+	SceneGraph();
+	~SceneGraph();
 
 	SceneNodeRef create_node();
 
+	/*
+	 * Destroy a node, its entity and components. Its children are moved to its parent.
+	 * Handles to the node become invalid, the slot is reused by the next created node.
+	 */
+	void destroy_node(const SceneNodeRef &node);
+
+	/*
+	 * Destroy a node and all of its descendants.
+	 * The hierarchy is compacted once and the entities are released together, rather than node by node.
+	 * Storage is kept and reused by the nodes created afterwards, so streaming scenes in and out does not grow memory.
+	 */
+	void destroy_subtree(const SceneNodeRef &node);
+
+	// move count nodes below the same parent, every handle is checked before any node is moved
+	void set_parent(const SceneNodeRef *children, size_t count, const SceneNodeRef &parent);
+
 	/*
 	 * Add a system to the scene graph.
 	 * Returns true if the system was added successfully.
@@ -50,6 +66,7 @@ class SceneGraph final
 	template <typename T>
 	bool remove_system()
 	{
+		scheduler.invalidate();
 		return systems.erase(typeid(T)) > 0;
 	}
 
@@ -61,8 +78,26 @@ class SceneGraph final
 
 	void update(float delta_time);
 
+	// propagate world matrices and run systems on a thread pool, nullptr to stay on the calling thread
+	void set_thread_pool(std::shared_ptr<ThreadPool> thread_pool)
+	{
+		this->thread_pool = std::move(thread_pool);
+	}
+
 	void print_scene_heirarchy(size_t spacing = 4) const;
 
+	// entities whose WorldBoundingBox intersects the frustum, as of the last update
+	void query_frustum(const Frustum &frustum, std::vector<entt::entity> &entities) const;
+
+	// entities whose WorldBoundingBox is hit by the ray, nearest first, as of the last update
+	void query_ray(const Ray &ray, std::vector<RayHit> &hits) const;
+
+	// per system timings and critical path of the last update
+	const SystemProfile &system_profile() const
+	{
+		return scheduler.profile();
+	}
+
 	entt::registry &registry()
 	{
 		return _registry;
@@ -71,12 +106,114 @@ class SceneGraph final
   private:
 	entt::registry                                     _registry;
 	std::map<std::type_index, std::shared_ptr<System>> systems;
+	SystemScheduler                                    scheduler;
+
+	// indexed by entity index, slots are recycled along with the entities
+	std::vector<SceneNode> nodes;
+
+	Hierarchy hierarchy{_registry};
+
+	// world bounding boxes of the nodes with a BoundingBox
+	DynamicBVH bvh;
 
-	std::vector<std::shared_ptr<SceneNode>> nodes;
+	// scratch used by destroy_subtree() and set_parent()
+	std::vector<entt::entity>  destroyed_entities;
+	std::vector<Hierarchy::Id> reparented_ids;
+
+	std::shared_ptr<ThreadPool> thread_pool;
 
 	bool add_system(const std::type_info &type_info, std::shared_ptr<System> &&system);
 
-	// used by print_scene_heirarchy()
-	void print_node(SceneNode &node, int depth, size_t spacing) const;
+	SceneNode &node(entt::entity entity)
+	{
+		return nodes[entt::to_entity(entity)];
+	}
+
+	// transform the bounding boxes of the nodes the last hierarchy update recomputed and refit the BVH
+	void update_bounds();
+
+	void on_bounding_box_changed(entt::registry &registry, entt::entity entity);
+	void on_bounding_box_destroyed(entt::registry &registry, entt::entity entity);
+
+	// used by print_scene_heirarchy(), nodes are identified by their hierarchy position
+	void print_node(uint32_t position, const std::vector<std::vector<uint32_t>> &children, int depth, size_t spacing) const;
 };
+
+inline bool SceneNodeRef::is_valid() const
+{
+	return scene_graph && scene_graph->_registry.valid(entity);
+}
+
+inline entt::registry &SceneNodeRef::checked_registry() const
+{
+	if (!is_valid())
+	{
+		throw std::runtime_error("Node is expired");
+	}
+	return scene_graph->_registry;
+}
+
+inline void SceneNodeRef::set_name(const std::string &name) const
+{
+	checked_registry();
+	scene_graph->node(entity).name = name;
+}
+
+inline const std::string &SceneNodeRef::get_name() const
+{
+	checked_registry();
+	return scene_graph->node(entity).name;
+}
+
+inline Transform &SceneNodeRef::transform()
+{
+	auto &registry = checked_registry();
+	scene_graph->hierarchy.mark_dirty(scene_graph->node(entity).id);
+	return registry.get<Transform>(entity);
+}
+
+template <typename T, typename... Args>
+T &SceneNodeRef::emplace_component(Args &&...args)
+{
+	return checked_registry().emplace_or_replace<T>(entity, std::forward<Args>(args)...);
+}
+
+template <typename T>
+T &SceneNodeRef::add_component(const T &component)
+{
+	return checked_registry().emplace_or_replace<T>(entity, component);
+}
+
+template <typename T>
+T &SceneNodeRef::get_component()
+{
+	return checked_registry().get<T>(entity);
+}
+
+template <typename T>
+bool SceneNodeRef::has_component()
+{
+	return checked_registry().all_of<T>(entity);
+}
+
+template <typename T>
+void SceneNodeRef::remove_component()
+{
+	checked_registry().remove<T>(entity);
+}
+
+inline void SceneNodeRef::set_parent(SceneNodeRef &new_parent)
+{
+	if (!is_valid() || !new_parent.is_valid())
+	{
+		throw std::runtime_error("Node is expired");
+	}
+
+	if (scene_graph != new_parent.scene_graph)
+	{
+		throw std::runtime_error("Cannot parent a node to a node of another scene graph");
+	}
+
+	scene_graph->hierarchy.set_parent(scene_graph->node(entity).id, new_parent.scene_graph->node(new_parent.entity).id);
+}
 }        // namespace remus
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "components/bounding_box.hpp"
+#include "transform.hpp"
+
+namespace remus
+{
+/* The components a system reads and writes.
+ * Systems whose accesses do not conflict may be run at the same time.
+ * A system which creates or destroys entities or components must be exclusive.
+ * Writing a Transform or a BoundingBox marks the node dirty in the hierarchy, so those writes also conflict with each other.
+ */
+class SystemAccess
+{
+  public:
+	// conflicts with every other system, the default for systems which do not declare their access
+	static SystemAccess exclusive()
+	{
+		SystemAccess access;
+		access.is_exclusive = true;
+		return access;
+	}
+
+	template <typename... T>
+	SystemAccess &read()
+	{
+		(add<T>(false), ...);
+		return *this;
+	}
+
+	template <typename... T>
+	SystemAccess &write()
+	{
+		(add<T>(true), ...);
+		return *this;
+	}
+
+	// true if either system writes a component the other one reads or writes
+	bool conflicts_with(const SystemAccess &other) const;
+
+	// create the storage of every declared component so that concurrent views do not modify the registry
+	void prepare(entt::registry &registry) const;
+
+  private:
+	// the dirty state of the hierarchy, written through the update signals of Transform and BoundingBox
+	struct HierarchyDirtyState
+	{
+	};
+
+	struct Component
+	{
+		std::type_index type;
+		bool            write;
+		void (*prepare)(entt::registry &registry);
+	};
+
+	std::vector<Component> components;
+	bool                   is_exclusive{false};
+
+	template <typename T>
+	void add(bool write)
+	{
+		components.push_back({std::type_index(typeid(T)), write, [](entt::registry &registry) {
+			                      (void) registry.view<T>();
+		                      }});
+
+		if constexpr (std::is_same_v<T, Transform> || std::is_same_v<T, BoundingBox>)
+		{
+			if (write)
+			{
+				components.push_back({std::type_index(typeid(HierarchyDirtyState)), true, [](entt::registry &) {}});
+			}
+		}
+	}
+};
+
+// Perform a process on a set of entities held in the scene graph.
+class System
+{
+  public:
+	virtual ~System()                                                     = default;
+	virtual void update(entt::registry &registry, float delta_time) const = 0;
+
+	// the components update() touches, systems that do not override this run on their own
+	virtual SystemAccess access() const
+	{
+		return SystemAccess::exclusive();
+	}
+};
+}        // namespace remus
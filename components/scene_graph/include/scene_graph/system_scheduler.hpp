@@ -0,0 +1,82 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+#include <core/thread_pool.hpp>
+#include <entt/entt.hpp>
+
+#include "system.hpp"
+
+namespace remus
+{
+struct SystemTiming
+{
+	std::type_index type;
+	double          start_ms;           // relative to the start of the run
+	double          duration_ms;
+};
+
+struct SystemProfile
+{
+	std::vector<SystemTiming> timings;
+
+	// the chain of dependent systems which bounds the frame time, in execution order
+	std::vector<std::type_index> critical_path;
+	double                       critical_path_ms{0.0};
+
+	double total_ms{0.0};
+};
+
+/* Runs systems in dependency order.
+ * A system depends on every system before it, in map order, with a conflicting access.
+ * With a thread pool, systems without pending dependencies run concurrently.
+ */
+class SystemScheduler
+{
+  public:
+	using Systems = std::map<std::type_index, std::shared_ptr<System>>;
+
+	// the dependency graph is rebuilt on the next run
+	void invalidate()
+	{
+		graph_valid = false;
+	}
+
+	void run(const Systems &systems, entt::registry &registry, float delta_time, ThreadPool *thread_pool);
+
+	// timings of the last run
+	const SystemProfile &profile() const
+	{
+		return last_profile;
+	}
+
+  private:
+	struct Node
+	{
+		std::type_index     type;
+		System             *system;
+		SystemAccess        access;
+		std::vector<size_t> dependents;
+		std::vector<size_t> dependencies;
+	};
+
+	// shared with the tasks of a parallel run
+	struct RunState;
+
+	std::vector<Node> nodes;
+	bool              graph_valid{false};
+
+	SystemProfile last_profile;
+
+	void build_graph(const Systems &systems);
+
+	void run_serial(entt::registry &registry, float delta_time);
+	void run_parallel(entt::registry &registry, float delta_time, ThreadPool &thread_pool);
+	void run_node(const std::shared_ptr<RunState> &state, size_t index);
+
+	void compute_critical_path();
+};
+}        // namespace remus
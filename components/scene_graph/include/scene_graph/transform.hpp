@@ -16,12 +16,14 @@ class Transform
 	glm::quat rotation    = glm::quat(0.0f, 0.0f, 0.0f, 1.0f);
 	glm::vec3 scale       = glm::vec3(1.0f);
 
+	// equivalent to translate * mat4_cast * scale without the full matrix multiplies
 	glm::mat4 get_matrix() const
 	{
-		glm::mat4 matrix(1.0f);
-		matrix = glm::translate(matrix, translation);
-		matrix *= glm::mat4_cast(rotation);
-		matrix = glm::scale(matrix, scale);
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= scale.x;
+		matrix[1] *= scale.y;
+		matrix[2] *= scale.z;
+		matrix[3] = glm::vec4(translation, 1.0f);
 		return matrix;
 	}
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+namespace remus
+{
+// Structure-of-arrays view of a batch of transforms, every array holds one component per transform
+struct TransformBatch
+{
+	const float *translation[3];        // x, y, z
+	const float *rotation[4];           // x, y, z, w
+	const float *scale[3];              // x, y, z
+};
+
+enum class TransformKernel
+{
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+// the fastest kernel supported by the CPU, detected once
+TransformKernel detect_transform_kernel();
+
+bool is_supported(TransformKernel kernel);
+
+/*
+ * Compose the local matrix of every transform in the batch and multiply it by its parent.
+ * Writes *worlds[i] = *parents[i] * T * R * S, or T * R * S when parents[i] is nullptr.
+ * Every kernel evaluates the same operations in the same order so their results are bit-identical.
+ */
+void compose_world_matrices(const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count);
+
+// as above with an explicit kernel, which must be supported
+void compose_world_matrices(TransformKernel kernel, const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count);
+}        // namespace remus
@@ -0,0 +1,239 @@
+#include "bvh.hpp"
+
+namespace remus
+{
+namespace
+{
+BoundingBox merged(const BoundingBox &a, const BoundingBox &b)
+{
+	BoundingBox box = a;
+	box.merge(b);
+	return box;
+}
+}        // namespace
+
+DynamicBVH::Proxy DynamicBVH::create_proxy(const BoundingBox &box, entt::entity entity)
+{
+	auto leaf = allocate_node();
+
+	auto &node   = nodes[leaf];
+	node.exact   = box;
+	node.box.min = box.min - glm::vec3(margin);
+	node.box.max = box.max + glm::vec3(margin);
+	node.entity  = entity;
+	node.height  = 0;
+
+	insert_leaf(leaf);
+	proxy_count++;
+
+	return leaf;
+}
+
+void DynamicBVH::destroy_proxy(Proxy proxy)
+{
+	remove_leaf(proxy);
+	free_node(proxy);
+	proxy_count--;
+}
+
+bool DynamicBVH::move_proxy(Proxy proxy, const BoundingBox &box)
+{
+	auto &node = nodes[proxy];
+	node.exact = box;
+
+	if (node.box.contains(box))
+	{
+		return false;
+	}
+
+	remove_leaf(proxy);
+
+	nodes[proxy].box.min = box.min - glm::vec3(margin);
+	nodes[proxy].box.max = box.max + glm::vec3(margin);
+
+	insert_leaf(proxy);
+	return true;
+}
+
+uint32_t DynamicBVH::allocate_node()
+{
+	if (free_nodes.empty())
+	{
+		nodes.emplace_back();
+		return static_cast<uint32_t>(nodes.size() - 1);
+	}
+
+	auto node = free_nodes.back();
+	free_nodes.pop_back();
+	nodes[node] = Node{};
+	return node;
+}
+
+void DynamicBVH::free_node(uint32_t node)
+{
+	nodes[node].height = -1;
+	free_nodes.push_back(node);
+}
+
+void DynamicBVH::insert_leaf(uint32_t leaf)
+{
+	if (root == null_proxy)
+	{
+		root               = leaf;
+		nodes[root].parent = null_proxy;
+		return;
+	}
+
+	// descend towards the sibling with the lowest increase in surface area
+	auto leaf_box = nodes[leaf].box;
+	auto index    = root;
+	while (!nodes[index].is_leaf())
+	{
+		auto &node = nodes[index];
+
+		float area          = node.box.area();
+		float combined_area = merged(node.box, leaf_box).area();
+
+		// cost of pairing the leaf with this node, and of pushing it further down
+		float cost             = 2.0f * combined_area;
+		float inheritance_cost = 2.0f * (combined_area - area);
+
+		float child_costs[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			auto &child    = nodes[node.children[i]];
+			float new_area = merged(child.box, leaf_box).area();
+			child_costs[i] = (child.is_leaf() ? new_area : new_area - child.box.area()) + inheritance_cost;
+		}
+
+		if (cost < child_costs[0] && cost < child_costs[1])
+		{
+			break;
+		}
+
+		index = child_costs[0] < child_costs[1] ? node.children[0] : node.children[1];
+	}
+
+	auto sibling    = index;
+	auto old_parent = nodes[sibling].parent;
+	auto new_parent = allocate_node();
+
+	nodes[new_parent].parent      = old_parent;
+	nodes[new_parent].box         = merged(leaf_box, nodes[sibling].box);
+	nodes[new_parent].height      = nodes[sibling].height + 1;
+	nodes[new_parent].children[0] = sibling;
+	nodes[new_parent].children[1] = leaf;
+	nodes[sibling].parent         = new_parent;
+	nodes[leaf].parent            = new_parent;
+
+	if (old_parent == null_proxy)
+	{
+		root = new_parent;
+	}
+	else
+	{
+		auto &children = nodes[old_parent].children;
+		children[children[0] == sibling ? 0 : 1] = new_parent;
+	}
+
+	refit(nodes[leaf].parent);
+}
+
+void DynamicBVH::remove_leaf(uint32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = null_proxy;
+		return;
+	}
+
+	auto parent       = nodes[leaf].parent;
+	auto grand_parent = nodes[parent].parent;
+	auto sibling      = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+
+	free_node(parent);
+
+	if (grand_parent == null_proxy)
+	{
+		root                  = sibling;
+		nodes[sibling].parent = null_proxy;
+		return;
+	}
+
+	auto &children = nodes[grand_parent].children;
+	children[children[0] == parent ? 0 : 1] = sibling;
+	nodes[sibling].parent                   = grand_parent;
+
+	refit(grand_parent);
+}
+
+void DynamicBVH::refit(uint32_t node)
+{
+	for (auto index = node; index != null_proxy; index = nodes[index].parent)
+	{
+		index = balance(index);
+
+		auto &current = nodes[index];
+		auto &first   = nodes[current.children[0]];
+		auto &second  = nodes[current.children[1]];
+
+		current.height = 1 + std::max(first.height, second.height);
+		current.box    = merged(first.box, second.box);
+	}
+}
+
+uint32_t DynamicBVH::balance(uint32_t a)
+{
+	if (nodes[a].is_leaf() || nodes[a].height < 2)
+	{
+		return a;
+	}
+
+	// the higher child becomes the root of the subtree, its lower child moves below a
+	auto b = nodes[a].children[0];
+	auto c = nodes[a].children[1];
+
+	int32_t difference = nodes[c].height - nodes[b].height;
+	if (difference >= -1 && difference <= 1)
+	{
+		return a;
+	}
+
+	int  raised_side = difference > 1 ? 1 : 0;
+	auto raised      = nodes[a].children[raised_side];
+	auto kept        = nodes[a].children[1 - raised_side];
+
+	auto f = nodes[raised].children[0];
+	auto g = nodes[raised].children[1];
+
+	// raised takes the place of a
+	nodes[raised].children[0] = a;
+	nodes[raised].parent      = nodes[a].parent;
+	nodes[a].parent           = raised;
+
+	if (nodes[raised].parent == null_proxy)
+	{
+		root = raised;
+	}
+	else
+	{
+		auto &children = nodes[nodes[raised].parent].children;
+		children[children[0] == a ? 0 : 1] = raised;
+	}
+
+	// the higher grandchild stays below raised, the lower one replaces raised below a
+	auto high = nodes[f].height > nodes[g].height ? f : g;
+	auto low  = high == f ? g : f;
+
+	nodes[raised].children[1]      = high;
+	nodes[a].children[raised_side] = low;
+	nodes[low].parent              = a;
+
+	nodes[a].box         = merged(nodes[kept].box, nodes[low].box);
+	nodes[a].height      = 1 + std::max(nodes[kept].height, nodes[low].height);
+	nodes[raised].box    = merged(nodes[a].box, nodes[high].box);
+	nodes[raised].height = 1 + std::max(nodes[a].height, nodes[high].height);
+
+	return raised;
+}
+}        // namespace remus
@@ -0,0 +1,474 @@
+#include "hierarchy.hpp"
+
+#include "transform_kernels.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace remus
+{
+namespace
+{
+// reorder values[offset, offset + order.size()) so that the element at offset + i moves to offset + order[i]
+template <typename T>
+void scatter(std::vector<T> &values, uint32_t offset, const std::vector<uint32_t> &order)
+{
+	std::vector<T> range(values.begin() + offset, values.end());
+	for (size_t i = 0; i < range.size(); ++i)
+	{
+		values[offset + order[i]] = std::move(range[i]);
+	}
+}
+}        // namespace
+
+Hierarchy::Hierarchy(entt::registry &registry) :
+    registry(&registry)
+{
+	registry.on_update<Transform>().connect<&Hierarchy::on_transform_update>(*this);
+}
+
+Hierarchy::~Hierarchy()
+{
+	registry->on_update<Transform>().disconnect<&Hierarchy::on_transform_update>(*this);
+}
+
+Hierarchy::Id Hierarchy::create(entt::entity entity)
+{
+	auto position = static_cast<uint32_t>(ids.size());
+
+	Id id;
+	if (!free_ids.empty())
+	{
+		id = free_ids.back();
+		free_ids.pop_back();
+		positions[id] = position;
+	}
+	else
+	{
+		id = static_cast<Id>(positions.size());
+		positions.push_back(position);
+	}
+
+	ids.push_back(id);
+	entities.push_back(entity);
+	parents.push_back(npos);
+	worlds.emplace_back(1.0f);
+	dirty.push_back(0);
+
+	auto index = entt::to_entity(entity);
+	if (index >= entity_ids.size())
+	{
+		entity_ids.resize(index + 1, npos);
+	}
+	entity_ids[index] = id;
+
+	registry->emplace<Transform>(entity);
+	registry->emplace<WorldMatrix>(entity, glm::mat4(1.0f));
+
+	mark_dirty(id);
+	return id;
+}
+
+void Hierarchy::destroy(Id id)
+{
+	sort();
+
+	auto position = positions[id];
+	auto parent   = parents[position];
+
+	// children take over the parent of the destroyed node and are recomputed
+	for (auto i = position + 1; i < ids.size(); ++i)
+	{
+		if (parents[i] == position)
+		{
+			parents[i] = parent;
+			dirty[i]   = 1;
+		}
+	}
+
+	marked.assign(ids.size() - position, 0);
+	marked[0] = 1;
+	removed_entities.clear();
+	remove(position);
+
+	registry->remove<Transform, WorldMatrix>(removed_entities.begin(), removed_entities.end());
+}
+
+void Hierarchy::destroy_subtree(Id id, std::vector<entt::entity> &destroyed)
+{
+	sort();
+
+	auto position = positions[id];
+
+	mark_subtree(position);
+	removed_entities.clear();
+	remove(position);
+
+	registry->remove<Transform, WorldMatrix>(removed_entities.begin(), removed_entities.end());
+	destroyed.insert(destroyed.end(), removed_entities.begin(), removed_entities.end());
+}
+
+void Hierarchy::set_parent(Id id, Id parent)
+{
+	auto position        = positions[id];
+	auto parent_position = positions[parent];
+
+	// a parent stored before the node cannot be one of its descendants while the arrays are sorted
+	if (first_unsorted != npos || parent_position >= position)
+	{
+		for (auto ancestor = parent_position; ancestor != npos; ancestor = parents[ancestor])
+		{
+			if (ancestor == position)
+			{
+				throw std::runtime_error("Cannot parent a node to itself or one of its descendants");
+			}
+		}
+	}
+
+	if (parent_position > position)
+	{
+		first_unsorted = std::min(first_unsorted, position);
+	}
+
+	parents[position] = parent_position;
+	mark_dirty(id);
+}
+
+void Hierarchy::set_parent(const Id *ids, size_t count, Id parent)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		set_parent(ids[i], parent);
+	}
+}
+
+Hierarchy::Id Hierarchy::get_parent(Id id) const
+{
+	auto parent = parents[positions[id]];
+	return parent == npos ? npos : ids[parent];
+}
+
+void Hierarchy::mark_dirty(Id id)
+{
+	auto position   = positions[id];
+	dirty[position] = 1;
+	first_dirty     = std::min(first_dirty, position);
+}
+
+void Hierarchy::on_transform_update(entt::registry &, entt::entity entity)
+{
+	auto index = entt::to_entity(entity);
+	if (index < entity_ids.size() && entity_ids[index] != npos && entities[positions[entity_ids[index]]] == entity)
+	{
+		mark_dirty(entity_ids[index]);
+	}
+}
+
+void Hierarchy::update(ThreadPool *thread_pool)
+{
+	// nodes handed to a worker at once, a multiple of the transform kernel batch size
+	constexpr size_t grain_size = 1024;
+
+	sort();
+
+	updated_positions.clear();
+
+	if (first_dirty == npos)
+	{
+		return;
+	}
+
+	levels.resize(ids.size());
+	level_offsets.clear();
+
+	// parents come first, so a dirty flag reaches every descendant within the same pass
+	for (auto position = first_dirty; position < ids.size(); ++position)
+	{
+		auto parent = parents[position];
+		if (parent != npos && dirty[parent])
+		{
+			dirty[position]  = 1;
+			levels[position] = levels[parent] + 1;
+		}
+		else if (dirty[position])
+		{
+			levels[position] = 0;
+		}
+		else
+		{
+			continue;
+		}
+
+		if (levels[position] + 1 >= level_offsets.size())
+		{
+			level_offsets.resize(levels[position] + 2, 0);
+		}
+		level_offsets[levels[position] + 1]++;
+
+		updated_positions.push_back(position);
+	}
+
+	first_dirty = npos;
+
+	if (updated_positions.empty())
+	{
+		return;
+	}
+
+	// counting sort of the updated positions by level, every level only depends on the ones before it
+	for (size_t level = 1; level < level_offsets.size(); ++level)
+	{
+		level_offsets[level] += level_offsets[level - 1];
+	}
+
+	level_order.resize(updated_positions.size());
+
+	std::vector<uint32_t> cursors(level_offsets.begin(), level_offsets.end() - 1);
+	for (auto position : updated_positions)
+	{
+		level_order[cursors[levels[position]]++] = position;
+	}
+
+	for (size_t level = 0; level + 1 < level_offsets.size(); ++level)
+	{
+		auto *begin = level_order.data() + level_offsets[level];
+		auto  count = level_offsets[level + 1] - level_offsets[level];
+
+		if (thread_pool)
+		{
+			thread_pool->parallel_for(count, grain_size, [&](size_t first, size_t last) {
+				compute_worlds(begin + first, last - first);
+			});
+		}
+		else
+		{
+			compute_worlds(begin, count);
+		}
+	}
+
+	// a plain write, replacing the component would copy it again and notify every listener
+	for (auto position : updated_positions)
+	{
+		registry->get<WorldMatrix>(entities[position]).matrix = worlds[position];
+		dirty[position]                                       = 0;
+	}
+}
+
+void Hierarchy::compute_worlds(const uint32_t *positions, size_t count)
+{
+	constexpr size_t batch_size = 64;
+
+	float            translation[3][batch_size];
+	float            rotation[4][batch_size];
+	float            scale[3][batch_size];
+	const glm::mat4 *parent_worlds[batch_size];
+	glm::mat4       *child_worlds[batch_size];
+
+	// const access only looks up the storage, which is safe from several workers
+	const entt::registry &components = *registry;
+
+	TransformBatch batch{{translation[0], translation[1], translation[2]},
+	                     {rotation[0], rotation[1], rotation[2], rotation[3]},
+	                     {scale[0], scale[1], scale[2]}};
+
+	for (size_t offset = 0; offset < count; offset += batch_size)
+	{
+		size_t batch_count = std::min(batch_size, count - offset);
+
+		for (size_t i = 0; i < batch_count; ++i)
+		{
+			auto  position = positions[offset + i];
+			auto &local    = components.get<Transform>(entities[position]);
+
+			translation[0][i] = local.translation.x;
+			translation[1][i] = local.translation.y;
+			translation[2][i] = local.translation.z;
+			rotation[0][i]    = local.rotation.x;
+			rotation[1][i]    = local.rotation.y;
+			rotation[2][i]    = local.rotation.z;
+			rotation[3][i]    = local.rotation.w;
+			scale[0][i]       = local.scale.x;
+			scale[1][i]       = local.scale.y;
+			scale[2][i]       = local.scale.z;
+
+			auto parent      = parents[position];
+			parent_worlds[i] = parent != npos ? &worlds[parent] : nullptr;
+			child_worlds[i]  = &worlds[position];
+		}
+
+		compose_world_matrices(batch, parent_worlds, child_worlds, batch_count);
+	}
+}
+
+uint32_t Hierarchy::mark_subtree(uint32_t position)
+{
+	auto count = static_cast<uint32_t>(ids.size()) - position;
+
+	// descendants are found in one forward scan as each parent is visited before its children
+	marked.assign(count, 0);
+	marked[0] = 1;
+
+	uint32_t subtree_size = 1;
+	for (uint32_t i = 1; i < count; ++i)
+	{
+		auto parent = parents[position + i];
+		if (parent != npos && parent >= position && marked[parent - position])
+		{
+			marked[i] = 1;
+			subtree_size++;
+		}
+	}
+
+	return subtree_size;
+}
+
+void Hierarchy::remove(uint32_t first)
+{
+	auto count = static_cast<uint32_t>(marked.size());
+
+	// new position of every kept node in the range, removed nodes never parent a kept one
+	remap.resize(count);
+
+	uint32_t next = first;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		remap[i] = marked[i] ? npos : next++;
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto position = first + i;
+		auto id       = ids[position];
+
+		if (marked[i])
+		{
+			positions[id] = npos;
+			free_ids.push_back(id);
+			entity_ids[entt::to_entity(entities[position])] = npos;
+			removed_entities.push_back(entities[position]);
+			continue;
+		}
+
+		auto target = remap[i];
+		auto parent = parents[position];
+
+		ids[target]      = id;
+		entities[target] = entities[position];
+		parents[target]  = parent != npos && parent >= first ? remap[parent - first] : parent;
+		worlds[target]   = worlds[position];
+		dirty[target]    = dirty[position];
+
+		positions[id] = target;
+	}
+
+	ids.resize(next);
+	entities.resize(next);
+	parents.resize(next);
+	worlds.resize(next);
+	dirty.resize(next);
+
+	// the range was rewritten, find its first dirty node again
+	if (first_dirty == npos || first_dirty >= first)
+	{
+		first_dirty = npos;
+		for (auto position = first; position < next; ++position)
+		{
+			if (dirty[position])
+			{
+				first_dirty = position;
+				break;
+			}
+		}
+	}
+}
+
+void Hierarchy::sort()
+{
+	if (first_unsorted == npos)
+	{
+		return;
+	}
+
+	auto first = first_unsorted;
+	auto count = static_cast<uint32_t>(ids.size()) - first;
+
+	first_unsorted = npos;
+
+	// children of every node in the range, in position order
+	child_offsets.assign(count + 1, 0);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto parent = parents[first + i];
+		if (parent != npos && parent >= first)
+		{
+			child_offsets[parent - first + 1]++;
+		}
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		child_offsets[i + 1] += child_offsets[i];
+	}
+
+	child_list.resize(child_offsets[count]);
+	remap.assign(child_offsets.begin(), child_offsets.end() - 1);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto parent = parents[first + i];
+		if (parent != npos && parent >= first)
+		{
+			child_list[remap[parent - first]++] = i;
+		}
+	}
+
+	// depth first from the nodes whose parent is outside of the range, remap holds the new relative position
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto parent = parents[first + i];
+		if (parent != npos && parent >= first)
+		{
+			continue;
+		}
+
+		stack.push_back(i);
+		while (!stack.empty())
+		{
+			auto node = stack.back();
+			stack.pop_back();
+
+			remap[node] = next++;
+
+			// pushed in reverse so that siblings keep their relative order
+			for (auto child = child_offsets[node + 1]; child > child_offsets[node]; --child)
+			{
+				stack.push_back(child_list[child - 1]);
+			}
+		}
+	}
+
+	// parents outside of the range keep their position
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto &parent = parents[first + i];
+		if (parent != npos && parent >= first)
+		{
+			parent = first + remap[parent - first];
+		}
+	}
+
+	scatter(ids, first, remap);
+	scatter(entities, first, remap);
+	scatter(parents, first, remap);
+	scatter(worlds, first, remap);
+	scatter(dirty, first, remap);
+
+	for (uint32_t i = first; i < ids.size(); ++i)
+	{
+		positions[ids[i]] = i;
+	}
+
+	// dirty nodes may have moved anywhere within the range
+	first_dirty = std::min(first_dirty, first);
+}
+}        // namespace remus
@@ -2,33 +2,181 @@
 
 #include <common/logging.hpp>
 
+#include <algorithm>
+
 namespace remus
 {
+SceneGraph::SceneGraph()
+{
+	_registry.on_construct<BoundingBox>().connect<&SceneGraph::on_bounding_box_changed>(*this);
+	_registry.on_update<BoundingBox>().connect<&SceneGraph::on_bounding_box_changed>(*this);
+	_registry.on_destroy<BoundingBox>().connect<&SceneGraph::on_bounding_box_destroyed>(*this);
+}
+
+SceneGraph::~SceneGraph()
+{
+	_registry.on_construct<BoundingBox>().disconnect<&SceneGraph::on_bounding_box_changed>(*this);
+	_registry.on_update<BoundingBox>().disconnect<&SceneGraph::on_bounding_box_changed>(*this);
+	_registry.on_destroy<BoundingBox>().disconnect<&SceneGraph::on_bounding_box_destroyed>(*this);
+}
+
 SceneNodeRef SceneGraph::create_node()
 {
-	auto node = std::make_shared<SceneNode>(_registry);
-	nodes.push_back(node);
-	return SceneNodeRef(std::weak_ptr<SceneNode>{node});
+	auto entity = _registry.create();
+
+	auto index = entt::to_entity(entity);
+	if (index >= nodes.size())
+	{
+		nodes.resize(index + 1);
+	}
+
+	auto &node = nodes[index];
+	node.name.clear();
+	node.id = hierarchy.create(entity);
+
+	return SceneNodeRef(*this, entity);
+}
+
+void SceneGraph::destroy_node(const SceneNodeRef &node_ref)
+{
+	if (!node_ref.is_valid())
+	{
+		throw std::runtime_error("Node is expired");
+	}
+
+	auto  entity = node_ref.get_entity();
+	auto &node   = this->node(entity);
+
+	hierarchy.destroy(node.id);
+	node.id = Hierarchy::npos;
+	node.name.clear();
+
+	_registry.destroy(entity);
+}
+
+void SceneGraph::destroy_subtree(const SceneNodeRef &node_ref)
+{
+	if (!node_ref.is_valid())
+	{
+		throw std::runtime_error("Node is expired");
+	}
+
+	destroyed_entities.clear();
+	hierarchy.destroy_subtree(node(node_ref.get_entity()).id, destroyed_entities);
+
+	for (auto entity : destroyed_entities)
+	{
+		auto &destroyed = node(entity);
+		destroyed.id    = Hierarchy::npos;
+		destroyed.name.clear();
+	}
+
+	_registry.destroy(destroyed_entities.begin(), destroyed_entities.end());
+}
+
+void SceneGraph::set_parent(const SceneNodeRef *children, size_t count, const SceneNodeRef &parent)
+{
+	if (!parent.is_valid() || parent.scene_graph != this)
+	{
+		throw std::runtime_error("Parent is expired or belongs to another scene graph");
+	}
+
+	reparented_ids.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!children[i].is_valid() || children[i].scene_graph != this)
+		{
+			throw std::runtime_error("Node is expired or belongs to another scene graph");
+		}
+		reparented_ids.push_back(node(children[i].get_entity()).id);
+	}
+
+	hierarchy.set_parent(reparented_ids.data(), reparented_ids.size(), node(parent.get_entity()).id);
 }
 
 void SceneGraph::update(float delta_time)
 {
-	// Update all world matrices and transforms
-	for (auto &node : nodes)
+	// Update the world matrices of the subtrees that changed, then their bounds
+	hierarchy.update(thread_pool.get());
+	update_bounds();
+
+	// Update all systems, non-conflicting systems run concurrently when a thread pool is set
+	scheduler.run(systems, _registry, delta_time, thread_pool.get());
+}
+
+void SceneGraph::update_bounds()
+{
+	for (auto position : hierarchy.updated())
+	{
+		auto  entity = hierarchy.entity_at(position);
+		auto *box    = _registry.try_get<BoundingBox>(entity);
+		if (!box)
+		{
+			continue;
+		}
+
+		auto world_box = box->transformed(hierarchy.world_at(position));
+
+		if (auto *current = _registry.try_get<WorldBoundingBox>(entity))
+		{
+			current->box = world_box;
+		}
+		else
+		{
+			_registry.emplace<WorldBoundingBox>(entity, world_box);
+		}
+
+		// only boxes which leave their fattened bounds change the tree
+		auto &proxy = node(entity).proxy;
+		if (proxy == DynamicBVH::null_proxy)
+		{
+			proxy = bvh.create_proxy(world_box, entity);
+		}
+		else
+		{
+			bvh.move_proxy(proxy, world_box);
+		}
+	}
+}
+
+void SceneGraph::on_bounding_box_changed(entt::registry &, entt::entity entity)
+{
+	// the box is transformed on the next update along with the world matrix
+	auto index = entt::to_entity(entity);
+	if (index < nodes.size() && nodes[index].id != Hierarchy::npos)
 	{
-		node->emplace_component<WorldMatrix>(node->get_world_matrix());
-		node->add_component(node->transform);
+		hierarchy.mark_dirty(nodes[index].id);
 	}
+}
 
-	// Update all systems
-	for (auto &system : systems)
+void SceneGraph::on_bounding_box_destroyed(entt::registry &, entt::entity entity)
+{
+	// the WorldBoundingBox is left as is, it goes away with the entity
+	auto index = entt::to_entity(entity);
+	if (index < nodes.size() && nodes[index].proxy != DynamicBVH::null_proxy)
 	{
-		system.second->update(_registry, delta_time);
+		bvh.destroy_proxy(nodes[index].proxy);
+		nodes[index].proxy = DynamicBVH::null_proxy;
 	}
 }
 
-void SceneGraph::print_node(SceneNode &node, int depth, size_t spacing) const
+void SceneGraph::query_frustum(const Frustum &frustum, std::vector<entt::entity> &entities) const
 {
+	bvh.query(frustum, [&](entt::entity entity) { entities.push_back(entity); });
+}
+
+void SceneGraph::query_ray(const Ray &ray, std::vector<RayHit> &hits) const
+{
+	auto first = hits.size();
+	bvh.ray_cast(ray, [&](entt::entity entity, float distance) { hits.push_back({entity, distance}); });
+
+	std::sort(hits.begin() + first, hits.end(), [](const RayHit &a, const RayHit &b) { return a.distance < b.distance; });
+}
+
+void SceneGraph::print_node(uint32_t position, const std::vector<std::vector<uint32_t>> &children, int depth, size_t spacing) const
+{
+	auto &node = nodes[entt::to_entity(hierarchy.entity_at(position))];
+
 	if (depth == 0)
 	{
 		LOGI("Scene heirarchy: {}", node.name);
@@ -36,27 +184,34 @@ void SceneGraph::print_node(SceneNode &node, int depth, size_t spacing) const
 
 	std::string indent(depth * spacing, ' ');
 	LOGI("{}| {}", indent, node.name);
-	for (auto &child : node.children)
+	for (auto child : children[position])
 	{
-		print_node(*child, depth + 1, spacing);
+		print_node(child, children, depth + 1, spacing);
 	}
 }
 
 void SceneGraph::print_scene_heirarchy(size_t spacing) const
 {
-	std::vector<std::shared_ptr<SceneNode>> roots;
+	// the hierarchy only stores parents, gather the children of every node
+	std::vector<std::vector<uint32_t>> children(hierarchy.size());
+	std::vector<uint32_t>              roots;
 
-	for (auto &node : nodes)
+	for (uint32_t position = 0; position < hierarchy.size(); ++position)
 	{
-		if (!node->parent)
+		auto parent = hierarchy.parent_at(position);
+		if (parent == Hierarchy::npos)
+		{
+			roots.push_back(position);
+		}
+		else
 		{
-			roots.push_back(node);
+			children[parent].push_back(position);
 		}
 	}
 
-	for (auto &root : roots)
+	for (auto root : roots)
 	{
-		print_node(*root, 0, spacing);
+		print_node(root, children, 0, spacing);
 	}
 }
 
@@ -72,6 +227,7 @@ bool SceneGraph::add_system(const std::type_info &type_info, std::shared_ptr<Sys
 	}
 
 	systems[std::type_index{type_info}] = system;
+	scheduler.invalidate();
 	return true;
 }
 }        // namespace remus
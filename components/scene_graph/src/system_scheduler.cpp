@@ -0,0 +1,249 @@
+#include "system_scheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace remus
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double milliseconds_between(Clock::time_point begin, Clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+}        // namespace
+
+bool SystemAccess::conflicts_with(const SystemAccess &other) const
+{
+	if (is_exclusive || other.is_exclusive)
+	{
+		return true;
+	}
+
+	for (auto &component : components)
+	{
+		for (auto &other_component : other.components)
+		{
+			if (component.type == other_component.type && (component.write || other_component.write))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void SystemAccess::prepare(entt::registry &registry) const
+{
+	for (auto &component : components)
+	{
+		component.prepare(registry);
+	}
+}
+
+struct SystemScheduler::RunState
+{
+	entt::registry   *registry;
+	float             delta_time;
+	ThreadPool       *thread_pool;
+	Clock::time_point start;
+
+	std::vector<std::atomic<size_t>> remaining_dependencies;
+
+	std::mutex              mutex;
+	std::condition_variable condition;
+	size_t                  completed{0};
+	std::exception_ptr      error;
+
+	explicit RunState(size_t node_count) :
+	    remaining_dependencies(node_count)
+	{}
+};
+
+void SystemScheduler::run(const Systems &systems, entt::registry &registry, float delta_time, ThreadPool *thread_pool)
+{
+	if (!graph_valid)
+	{
+		build_graph(systems);
+	}
+
+	auto start = Clock::now();
+
+	if (thread_pool && thread_pool->size() > 0 && nodes.size() > 1)
+	{
+		run_parallel(registry, delta_time, *thread_pool);
+	}
+	else
+	{
+		run_serial(registry, delta_time);
+	}
+
+	last_profile.total_ms = milliseconds_between(start, Clock::now());
+
+	compute_critical_path();
+}
+
+void SystemScheduler::build_graph(const Systems &systems)
+{
+	nodes.clear();
+	last_profile.timings.clear();
+
+	for (auto &system : systems)
+	{
+		nodes.push_back({system.first, system.second.get(), system.second->access(), {}, {}});
+		last_profile.timings.push_back({system.first, 0.0, 0.0});
+	}
+
+	// only earlier systems can be dependencies, which keeps the graph acyclic and the serial order intact
+	for (size_t later = 0; later < nodes.size(); ++later)
+	{
+		for (size_t earlier = 0; earlier < later; ++earlier)
+		{
+			if (nodes[earlier].access.conflicts_with(nodes[later].access))
+			{
+				nodes[earlier].dependents.push_back(later);
+				nodes[later].dependencies.push_back(earlier);
+			}
+		}
+	}
+
+	graph_valid = true;
+}
+
+void SystemScheduler::run_serial(entt::registry &registry, float delta_time)
+{
+	auto start = Clock::now();
+
+	for (size_t index = 0; index < nodes.size(); ++index)
+	{
+		auto begin = Clock::now();
+		nodes[index].system->update(registry, delta_time);
+		auto end = Clock::now();
+
+		last_profile.timings[index].start_ms    = milliseconds_between(start, begin);
+		last_profile.timings[index].duration_ms = milliseconds_between(begin, end);
+	}
+}
+
+void SystemScheduler::run_parallel(entt::registry &registry, float delta_time, ThreadPool &thread_pool)
+{
+	// storages are created up front as views on a missing storage would modify the registry concurrently
+	for (auto &node : nodes)
+	{
+		node.access.prepare(registry);
+	}
+
+	auto state         = std::make_shared<RunState>(nodes.size());
+	state->registry    = &registry;
+	state->delta_time  = delta_time;
+	state->thread_pool = &thread_pool;
+	state->start       = Clock::now();
+
+	for (size_t index = 0; index < nodes.size(); ++index)
+	{
+		state->remaining_dependencies[index] = nodes[index].dependencies.size();
+	}
+
+	for (size_t index = 0; index < nodes.size(); ++index)
+	{
+		if (nodes[index].dependencies.empty())
+		{
+			thread_pool.submit([this, state, index]() { run_node(state, index); });
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&]() { return state->completed == nodes.size(); });
+
+	if (state->error)
+	{
+		std::rethrow_exception(state->error);
+	}
+}
+
+void SystemScheduler::run_node(const std::shared_ptr<RunState> &state, size_t index)
+{
+	auto &node = nodes[index];
+
+	auto begin = Clock::now();
+	try
+	{
+		node.system->update(*state->registry, state->delta_time);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (!state->error)
+		{
+			state->error = std::current_exception();
+		}
+	}
+	auto end = Clock::now();
+
+	last_profile.timings[index].start_ms    = milliseconds_between(state->start, begin);
+	last_profile.timings[index].duration_ms = milliseconds_between(begin, end);
+
+	for (auto dependent : node.dependents)
+	{
+		if (--state->remaining_dependencies[dependent] == 0)
+		{
+			state->thread_pool->submit([this, state, dependent]() { run_node(state, dependent); });
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if (++state->completed == nodes.size())
+	{
+		state->condition.notify_all();
+	}
+}
+
+void SystemScheduler::compute_critical_path()
+{
+	auto &timings = last_profile.timings;
+
+	last_profile.critical_path.clear();
+	last_profile.critical_path_ms = 0.0;
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	// nodes are in topological order, so the longest chain ending at each node is known once its dependencies are
+	std::vector<double> finish(nodes.size(), 0.0);
+	std::vector<size_t> previous(nodes.size(), nodes.size());
+
+	size_t last = 0;
+	for (size_t index = 0; index < nodes.size(); ++index)
+	{
+		for (auto dependency : nodes[index].dependencies)
+		{
+			if (finish[dependency] > finish[index])
+			{
+				finish[index]   = finish[dependency];
+				previous[index] = dependency;
+			}
+		}
+		finish[index] += timings[index].duration_ms;
+
+		if (finish[index] > finish[last])
+		{
+			last = index;
+		}
+	}
+
+	last_profile.critical_path_ms = finish[last];
+
+	for (auto index = last; index < nodes.size(); index = previous[index])
+	{
+		last_profile.critical_path.insert(last_profile.critical_path.begin(), nodes[index].type);
+	}
+}
+}        // namespace remus
@@ -0,0 +1,348 @@
+#include "transform_kernels.hpp"
+
+#include <common/logging.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define REMUS_TRANSFORM_KERNELS_X86
+#	include <immintrin.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#		define REMUS_TARGET_AVX2
+#	else
+#		define REMUS_TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#endif
+
+namespace remus
+{
+namespace
+{
+// columns 0 to 2 of the local matrix, stored row by row, followed by the translation
+constexpr size_t local_value_count = 12;
+
+inline void compose_local(const TransformBatch &batch, size_t i, float local[local_value_count])
+{
+	float x = batch.rotation[0][i];
+	float y = batch.rotation[1][i];
+	float z = batch.rotation[2][i];
+	float w = batch.rotation[3][i];
+
+	float qxx = x * x;
+	float qyy = y * y;
+	float qzz = z * z;
+	float qxz = x * z;
+	float qxy = x * y;
+	float qyz = y * z;
+	float qwx = w * x;
+	float qwy = w * y;
+	float qwz = w * z;
+
+	float sx = batch.scale[0][i];
+	float sy = batch.scale[1][i];
+	float sz = batch.scale[2][i];
+
+	// same terms as glm::mat3_cast, scaled per column
+	local[0]  = (1.0f - 2.0f * (qyy + qzz)) * sx;
+	local[1]  = (2.0f * (qxy + qwz)) * sx;
+	local[2]  = (2.0f * (qxz - qwy)) * sx;
+	local[3]  = (2.0f * (qxy - qwz)) * sy;
+	local[4]  = (1.0f - 2.0f * (qxx + qzz)) * sy;
+	local[5]  = (2.0f * (qyz + qwx)) * sy;
+	local[6]  = (2.0f * (qxz + qwy)) * sz;
+	local[7]  = (2.0f * (qyz - qwx)) * sz;
+	local[8]  = (1.0f - 2.0f * (qxx + qyy)) * sz;
+	local[9]  = batch.translation[0][i];
+	local[10] = batch.translation[1][i];
+	local[11] = batch.translation[2][i];
+}
+
+inline void store_local(const float local[local_value_count], glm::mat4 &world)
+{
+	world[0] = glm::vec4(local[0], local[1], local[2], 0.0f);
+	world[1] = glm::vec4(local[3], local[4], local[5], 0.0f);
+	world[2] = glm::vec4(local[6], local[7], local[8], 0.0f);
+	world[3] = glm::vec4(local[9], local[10], local[11], 1.0f);
+}
+
+// the local matrix extended with its implicit last row
+inline float local_element(const float local[local_value_count], int column, int row)
+{
+	if (row == 3)
+	{
+		return column == 3 ? 1.0f : 0.0f;
+	}
+	return local[column * 3 + row];
+}
+
+void compose_scalar(const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		float local[local_value_count];
+		compose_local(batch, i, local);
+
+		if (!parents[i])
+		{
+			store_local(local, *worlds[i]);
+			continue;
+		}
+
+		auto &parent = *parents[i];
+		auto &world  = *worlds[i];
+		for (int column = 0; column < 4; ++column)
+		{
+			float l0 = local_element(local, column, 0);
+			float l1 = local_element(local, column, 1);
+			float l2 = local_element(local, column, 2);
+			float l3 = local_element(local, column, 3);
+			for (int row = 0; row < 4; ++row)
+			{
+				world[column][row] = parent[0][row] * l0 + parent[1][row] * l1 + parent[2][row] * l2 + parent[3][row] * l3;
+			}
+		}
+	}
+}
+
+#if defined(REMUS_TRANSFORM_KERNELS_X86)
+// every lane of the local values for up to eight transforms, indexed [value][lane]
+using LocalLanes = float[local_value_count][8];
+
+inline void gather_local(const LocalLanes &lanes, size_t lane, float local[local_value_count])
+{
+	for (size_t value = 0; value < local_value_count; ++value)
+	{
+		local[value] = lanes[value][lane];
+	}
+}
+
+inline void multiply_sse2(const glm::mat4 &parent, const float local[local_value_count], glm::mat4 &world)
+{
+	__m128 p0 = _mm_loadu_ps(&parent[0][0]);
+	__m128 p1 = _mm_loadu_ps(&parent[1][0]);
+	__m128 p2 = _mm_loadu_ps(&parent[2][0]);
+	__m128 p3 = _mm_loadu_ps(&parent[3][0]);
+
+	for (int column = 0; column < 4; ++column)
+	{
+		__m128 result = _mm_mul_ps(p0, _mm_set1_ps(local_element(local, column, 0)));
+		result        = _mm_add_ps(result, _mm_mul_ps(p1, _mm_set1_ps(local_element(local, column, 1))));
+		result        = _mm_add_ps(result, _mm_mul_ps(p2, _mm_set1_ps(local_element(local, column, 2))));
+		result        = _mm_add_ps(result, _mm_mul_ps(p3, _mm_set1_ps(local_element(local, column, 3))));
+		_mm_storeu_ps(&world[column][0], result);
+	}
+}
+
+void compose_sse2(const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(batch.rotation[0] + i);
+		__m128 y = _mm_loadu_ps(batch.rotation[1] + i);
+		__m128 z = _mm_loadu_ps(batch.rotation[2] + i);
+		__m128 w = _mm_loadu_ps(batch.rotation[3] + i);
+
+		__m128 qxx = _mm_mul_ps(x, x);
+		__m128 qyy = _mm_mul_ps(y, y);
+		__m128 qzz = _mm_mul_ps(z, z);
+		__m128 qxz = _mm_mul_ps(x, z);
+		__m128 qxy = _mm_mul_ps(x, y);
+		__m128 qyz = _mm_mul_ps(y, z);
+		__m128 qwx = _mm_mul_ps(w, x);
+		__m128 qwy = _mm_mul_ps(w, y);
+		__m128 qwz = _mm_mul_ps(w, z);
+
+		__m128 sx = _mm_loadu_ps(batch.scale[0] + i);
+		__m128 sy = _mm_loadu_ps(batch.scale[1] + i);
+		__m128 sz = _mm_loadu_ps(batch.scale[2] + i);
+
+		alignas(16) LocalLanes lanes;
+		_mm_store_ps(lanes[0], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))), sx));
+		_mm_store_ps(lanes[1], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxy, qwz)), sx));
+		_mm_store_ps(lanes[2], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)), sx));
+		_mm_store_ps(lanes[3], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)), sy));
+		_mm_store_ps(lanes[4], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))), sy));
+		_mm_store_ps(lanes[5], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qyz, qwx)), sy));
+		_mm_store_ps(lanes[6], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxz, qwy)), sz));
+		_mm_store_ps(lanes[7], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)), sz));
+		_mm_store_ps(lanes[8], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))), sz));
+		_mm_store_ps(lanes[9], _mm_loadu_ps(batch.translation[0] + i));
+		_mm_store_ps(lanes[10], _mm_loadu_ps(batch.translation[1] + i));
+		_mm_store_ps(lanes[11], _mm_loadu_ps(batch.translation[2] + i));
+
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			float local[local_value_count];
+			gather_local(lanes, lane, local);
+
+			if (parents[i + lane])
+			{
+				multiply_sse2(*parents[i + lane], local, *worlds[i + lane]);
+			}
+			else
+			{
+				store_local(local, *worlds[i + lane]);
+			}
+		}
+	}
+
+	compose_scalar(batch, parents, worlds, i, count);
+}
+
+// two columns per instruction, the parent column is repeated in both halves
+REMUS_TARGET_AVX2 inline __m256 broadcast_column(const glm::mat4 &matrix, int column)
+{
+	__m128 value = _mm_loadu_ps(&matrix[column][0]);
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(value), value, 1);
+}
+
+REMUS_TARGET_AVX2 inline __m256 column_pair(const float local[local_value_count], int column, int row)
+{
+	float low  = local_element(local, column, row);
+	float high = local_element(local, column + 1, row);
+	return _mm256_set_ps(high, high, high, high, low, low, low, low);
+}
+
+REMUS_TARGET_AVX2 void multiply_avx2(const glm::mat4 &parent, const float local[local_value_count], glm::mat4 &world)
+{
+	__m256 p0 = broadcast_column(parent, 0);
+	__m256 p1 = broadcast_column(parent, 1);
+	__m256 p2 = broadcast_column(parent, 2);
+	__m256 p3 = broadcast_column(parent, 3);
+
+	for (int column = 0; column < 4; column += 2)
+	{
+		__m256 result = _mm256_mul_ps(p0, column_pair(local, column, 0));
+		result        = _mm256_add_ps(result, _mm256_mul_ps(p1, column_pair(local, column, 1)));
+		result        = _mm256_add_ps(result, _mm256_mul_ps(p2, column_pair(local, column, 2)));
+		result        = _mm256_add_ps(result, _mm256_mul_ps(p3, column_pair(local, column, 3)));
+		_mm256_storeu_ps(&world[column][0], result);
+	}
+}
+
+REMUS_TARGET_AVX2 void compose_avx2(const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(batch.rotation[0] + i);
+		__m256 y = _mm256_loadu_ps(batch.rotation[1] + i);
+		__m256 z = _mm256_loadu_ps(batch.rotation[2] + i);
+		__m256 w = _mm256_loadu_ps(batch.rotation[3] + i);
+
+		__m256 qxx = _mm256_mul_ps(x, x);
+		__m256 qyy = _mm256_mul_ps(y, y);
+		__m256 qzz = _mm256_mul_ps(z, z);
+		__m256 qxz = _mm256_mul_ps(x, z);
+		__m256 qxy = _mm256_mul_ps(x, y);
+		__m256 qyz = _mm256_mul_ps(y, z);
+		__m256 qwx = _mm256_mul_ps(w, x);
+		__m256 qwy = _mm256_mul_ps(w, y);
+		__m256 qwz = _mm256_mul_ps(w, z);
+
+		__m256 sx = _mm256_loadu_ps(batch.scale[0] + i);
+		__m256 sy = _mm256_loadu_ps(batch.scale[1] + i);
+		__m256 sz = _mm256_loadu_ps(batch.scale[2] + i);
+
+		alignas(32) LocalLanes lanes;
+		_mm256_store_ps(lanes[0], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz))), sx));
+		_mm256_store_ps(lanes[1], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxy, qwz)), sx));
+		_mm256_store_ps(lanes[2], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy)), sx));
+		_mm256_store_ps(lanes[3], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz)), sy));
+		_mm256_store_ps(lanes[4], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz))), sy));
+		_mm256_store_ps(lanes[5], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qyz, qwx)), sy));
+		_mm256_store_ps(lanes[6], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxz, qwy)), sz));
+		_mm256_store_ps(lanes[7], _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx)), sz));
+		_mm256_store_ps(lanes[8], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy))), sz));
+		_mm256_store_ps(lanes[9], _mm256_loadu_ps(batch.translation[0] + i));
+		_mm256_store_ps(lanes[10], _mm256_loadu_ps(batch.translation[1] + i));
+		_mm256_store_ps(lanes[11], _mm256_loadu_ps(batch.translation[2] + i));
+
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			float local[local_value_count];
+			gather_local(lanes, lane, local);
+
+			if (parents[i + lane])
+			{
+				multiply_avx2(*parents[i + lane], local, *worlds[i + lane]);
+			}
+			else
+			{
+				store_local(local, *worlds[i + lane]);
+			}
+		}
+	}
+
+	compose_scalar(batch, parents, worlds, i, count);
+}
+#endif
+}        // namespace
+
+TransformKernel detect_transform_kernel()
+{
+	static const TransformKernel kernel = []() {
+#if defined(REMUS_TRANSFORM_KERNELS_X86)
+#	if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7)
+		{
+			__cpuidex(info, 1, 0);
+			bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			if (os_saves_ymm && (info[1] & (1 << 5)))
+			{
+				return TransformKernel::AVX2;
+			}
+		}
+		return TransformKernel::SSE2;
+#	else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? TransformKernel::AVX2 : TransformKernel::SSE2;
+#	endif
+#else
+		return TransformKernel::Scalar;
+#endif
+	}();
+
+	return kernel;
+}
+
+bool is_supported(TransformKernel kernel)
+{
+	return static_cast<int>(kernel) <= static_cast<int>(detect_transform_kernel());
+}
+
+void compose_world_matrices(const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count)
+{
+	compose_world_matrices(detect_transform_kernel(), batch, parents, worlds, count);
+}
+
+void compose_world_matrices(TransformKernel kernel, const TransformBatch &batch, const glm::mat4 *const *parents, glm::mat4 *const *worlds, size_t count)
+{
+	LOG_ASSERT(!is_supported(kernel), "Transform kernel is not supported by this CPU");
+
+	switch (kernel)
+	{
+#if defined(REMUS_TRANSFORM_KERNELS_X86)
+		case TransformKernel::AVX2:
+			compose_avx2(batch, parents, worlds, count);
+			break;
+		case TransformKernel::SSE2:
+			compose_sse2(batch, parents, worlds, count);
+			break;
+#endif
+		default:
+			compose_scalar(batch, parents, worlds, 0, count);
+			break;
+	}
+}
+}        // namespace remus
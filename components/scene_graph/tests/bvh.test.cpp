@@ -0,0 +1,173 @@
+#include <scene_graph/bvh.hpp>
+#include <scene_graph/scene_graph.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+remus::BoundingBox random_box(std::mt19937 &rng)
+{
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+	remus::BoundingBox box;
+	box.min = glm::vec3(position(rng), position(rng), position(rng));
+	box.max = box.min + glm::vec3(size(rng), size(rng), size(rng));
+	return box;
+}
+
+std::vector<entt::entity> sorted(std::vector<entt::entity> entities)
+{
+	std::sort(entities.begin(), entities.end());
+	return entities;
+}
+}        // namespace
+
+TEST_CASE("BVH queries match a brute force search", "[scene_graph]")
+{
+	std::mt19937 rng(11);
+
+	remus::DynamicBVH                     bvh;
+	std::vector<remus::BoundingBox>       boxes;
+	std::vector<remus::DynamicBVH::Proxy> proxies;
+
+	for (uint32_t i = 0; i < 2000; ++i)
+	{
+		boxes.push_back(random_box(rng));
+		proxies.push_back(bvh.create_proxy(boxes.back(), static_cast<entt::entity>(i)));
+	}
+
+	// move some boxes a little, some a lot, and remove others
+	std::vector<bool> alive(boxes.size(), true);
+	for (uint32_t i = 0; i < boxes.size(); i += 3)
+	{
+		if (i % 2 == 0)
+		{
+			boxes[i].min += glm::vec3(0.01f);
+			boxes[i].max += glm::vec3(0.01f);
+		}
+		else
+		{
+			boxes[i] = random_box(rng);
+		}
+		bvh.move_proxy(proxies[i], boxes[i]);
+	}
+	for (uint32_t i = 1; i < boxes.size(); i += 7)
+	{
+		bvh.destroy_proxy(proxies[i]);
+		alive[i] = false;
+	}
+
+	REQUIRE(bvh.size() == static_cast<size_t>(std::count(alive.begin(), alive.end(), true)));
+
+	// a balanced tree stays within a small factor of log2(n)
+	REQUIRE(bvh.height() <= 2 * static_cast<int32_t>(std::log2(bvh.size())) + 2);
+
+	SECTION("Frustum")
+	{
+		auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 150.0f);
+		auto view       = glm::lookAt(glm::vec3(0.0f, 0.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		auto frustum    = remus::Frustum::from_matrix(projection * view);
+
+		std::vector<entt::entity> expected;
+		std::vector<entt::entity> visible;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (alive[i] && frustum.classify(boxes[i]) != remus::Frustum::Result::Outside)
+			{
+				expected.push_back(static_cast<entt::entity>(i));
+			}
+		}
+		bvh.query(frustum, [&](entt::entity entity) { visible.push_back(entity); });
+
+		REQUIRE(!expected.empty());
+		REQUIRE(expected.size() < bvh.size());
+		REQUIRE(sorted(visible) == sorted(expected));
+	}
+
+	SECTION("Box")
+	{
+		remus::BoundingBox region;
+		region.min = glm::vec3(-20.0f);
+		region.max = glm::vec3(20.0f);
+
+		std::vector<entt::entity> expected;
+		std::vector<entt::entity> overlapping;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (alive[i] && boxes[i].overlaps(region))
+			{
+				expected.push_back(static_cast<entt::entity>(i));
+			}
+		}
+		bvh.query(region, [&](entt::entity entity) { overlapping.push_back(entity); });
+
+		REQUIRE(sorted(overlapping) == sorted(expected));
+	}
+
+	SECTION("Ray")
+	{
+		remus::Ray ray(glm::vec3(-150.0f, 1.0f, 2.0f), glm::normalize(glm::vec3(1.0f, 0.01f, -0.02f)));
+
+		std::vector<entt::entity> expected;
+		std::vector<entt::entity> hits;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			float distance;
+			if (alive[i] && ray.intersects(boxes[i], distance))
+			{
+				expected.push_back(static_cast<entt::entity>(i));
+			}
+		}
+		bvh.ray_cast(ray, [&](entt::entity entity, float) { hits.push_back(entity); });
+
+		REQUIRE(sorted(hits) == sorted(expected));
+	}
+}
+
+TEST_CASE("World bounding boxes follow their nodes", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto parent = scene_graph.create_node();
+	auto child  = scene_graph.create_node();
+	child.set_parent(parent);
+
+	parent.transform().rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	child.transform().rotation  = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+	remus::BoundingBox box;
+	box.min = glm::vec3(-1.0f);
+	box.max = glm::vec3(1.0f);
+	child.add_component(box);
+
+	scene_graph.update(0.0f);
+	REQUIRE(child.get_component<remus::WorldBoundingBox>().box.max == glm::vec3(1.0f));
+
+	// moving the parent moves the child's bounds and its place in the BVH
+	parent.transform().translation = glm::vec3(100.0f, 0.0f, 0.0f);
+	scene_graph.update(0.0f);
+	REQUIRE(child.get_component<remus::WorldBoundingBox>().box.max == glm::vec3(101.0f, 1.0f, 1.0f));
+
+	std::vector<remus::RayHit> hits;
+	scene_graph.query_ray(remus::Ray(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f)), hits);
+	REQUIRE(hits.size() == 1);
+	REQUIRE(hits[0].entity == child.get_entity());
+	REQUIRE(hits[0].distance == 99.0f);
+
+	auto frustum = remus::Frustum::from_matrix(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 10.0f));
+
+	std::vector<entt::entity> visible;
+	scene_graph.query_frustum(frustum, visible);
+	REQUIRE(visible.empty());
+
+	// destroyed nodes leave the BVH
+	scene_graph.destroy_node(child);
+	hits.clear();
+	scene_graph.query_ray(remus::Ray(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f)), hits);
+	REQUIRE(hits.empty());
+}
@@ -0,0 +1,330 @@
+#include <scene_graph/hierarchy.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+glm::mat4 expected_world(const remus::Hierarchy &hierarchy, std::vector<remus::Transform> &locals, remus::Hierarchy::Id id)
+{
+	auto parent = hierarchy.get_parent(id);
+	if (parent == remus::Hierarchy::npos)
+	{
+		return locals[id].get_matrix();
+	}
+	return expected_world(hierarchy, locals, parent) * locals[id].get_matrix();
+}
+}        // namespace
+
+TEST_CASE("Reparent below a node created later", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	auto child  = hierarchy.create(registry.create());
+	auto leaf   = hierarchy.create(registry.create());
+	auto parent = hierarchy.create(registry.create());
+
+	hierarchy.set_parent(leaf, child);
+	hierarchy.set_parent(child, parent);
+
+	REQUIRE(hierarchy.get_parent(child) == parent);
+	REQUIRE(hierarchy.get_parent(leaf) == child);
+	REQUIRE(hierarchy.get_parent(parent) == remus::Hierarchy::npos);
+
+	hierarchy.local(parent).translation = glm::vec3(1.0f, 0.0f, 0.0f);
+	hierarchy.local(child).translation  = glm::vec3(0.0f, 1.0f, 0.0f);
+	hierarchy.local(leaf).translation   = glm::vec3(0.0f, 0.0f, 1.0f);
+	hierarchy.update();
+
+	REQUIRE(hierarchy.updated().size() == 3);
+	REQUIRE(hierarchy.world(leaf) == hierarchy.world(parent) * hierarchy.local(child).get_matrix() * hierarchy.local(leaf).get_matrix());
+}
+
+TEST_CASE("Reject cycles", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	auto a = hierarchy.create(registry.create());
+	auto b = hierarchy.create(registry.create());
+
+	hierarchy.set_parent(b, a);
+
+	REQUIRE_THROWS(hierarchy.set_parent(a, b));
+	REQUIRE_THROWS(hierarchy.set_parent(a, a));
+}
+
+TEST_CASE("Only dirty subtrees are updated", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	auto root    = hierarchy.create(registry.create());
+	auto child   = hierarchy.create(registry.create());
+	auto sibling = hierarchy.create(registry.create());
+
+	hierarchy.set_parent(child, root);
+	hierarchy.set_parent(sibling, root);
+	hierarchy.update();
+
+	hierarchy.update();
+	REQUIRE(hierarchy.updated().empty());
+
+	hierarchy.mark_dirty(child);
+	hierarchy.update();
+	REQUIRE(hierarchy.updated().size() == 1);
+
+	hierarchy.mark_dirty(root);
+	hierarchy.update();
+	REQUIRE(hierarchy.updated().size() == 3);
+}
+
+TEST_CASE("Transforms replaced through the registry are updated", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	auto entity = registry.create();
+	auto id     = hierarchy.create(entity);
+	hierarchy.update();
+
+	REQUIRE(registry.get<remus::WorldMatrix>(entity).matrix == hierarchy.world(id));
+
+	registry.patch<remus::Transform>(entity, [](auto &transform) { transform.translation = glm::vec3(1.0f, 2.0f, 3.0f); });
+	hierarchy.update();
+
+	REQUIRE(hierarchy.updated().size() == 1);
+	REQUIRE(registry.get<remus::WorldMatrix>(entity).matrix[3] == glm::vec4(1.0f, 2.0f, 3.0f, 1.0f));
+}
+
+TEST_CASE("Random reparenting matches a recursive evaluation", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	std::mt19937                          rng(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	std::vector<remus::Transform> locals(256);
+	for (auto &local : locals)
+	{
+		auto id = hierarchy.create(registry.create());
+
+		local.translation = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+		local.scale       = glm::vec3(1.0f + 0.1f * distribution(rng));
+
+		hierarchy.local(id) = local;
+	}
+
+	for (int i = 0; i < 1024; ++i)
+	{
+		auto id     = static_cast<remus::Hierarchy::Id>(rng() % locals.size());
+		auto parent = static_cast<remus::Hierarchy::Id>(rng() % locals.size());
+
+		bool creates_cycle = false;
+		for (auto ancestor = parent; ancestor != remus::Hierarchy::npos; ancestor = hierarchy.get_parent(ancestor))
+		{
+			creates_cycle |= ancestor == id;
+		}
+
+		if (creates_cycle)
+		{
+			REQUIRE_THROWS(hierarchy.set_parent(id, parent));
+		}
+		else
+		{
+			hierarchy.set_parent(id, parent);
+		}
+	}
+
+	hierarchy.update();
+
+	for (remus::Hierarchy::Id id = 0; id < locals.size(); ++id)
+	{
+		REQUIRE(hierarchy.world(id) == expected_world(hierarchy, locals, id));
+	}
+}
+
+TEST_CASE("Parallel update is bit-identical to the serial update", "[scene_graph]")
+{
+	entt::registry   serial_registry;
+	entt::registry   parallel_registry;
+	remus::Hierarchy serial(serial_registry);
+	remus::Hierarchy parallel(parallel_registry);
+
+	remus::ThreadPool thread_pool(3);
+
+	std::mt19937                          rng(7);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	constexpr size_t node_count = 20000;
+
+	for (size_t i = 0; i < node_count; ++i)
+	{
+		remus::Transform local;
+		local.translation = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+		local.rotation    = glm::normalize(glm::quat(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+		local.scale       = glm::vec3(1.0f + 0.1f * distribution(rng));
+
+		auto serial_id   = serial.create(serial_registry.create());
+		auto parallel_id = parallel.create(parallel_registry.create());
+
+		serial.local(serial_id)     = local;
+		parallel.local(parallel_id) = local;
+
+		if (i > 0)
+		{
+			auto parent = static_cast<remus::Hierarchy::Id>(rng() % i);
+			serial.set_parent(serial_id, parent);
+			parallel.set_parent(parallel_id, parent);
+		}
+	}
+
+	serial.update();
+	parallel.update(&thread_pool);
+
+	REQUIRE(serial.updated() == parallel.updated());
+
+	for (remus::Hierarchy::Id id = 0; id < node_count; ++id)
+	{
+		REQUIRE(std::memcmp(&serial.world(id), &parallel.world(id), sizeof(glm::mat4)) == 0);
+	}
+}
+
+TEST_CASE("Ids of destroyed nodes are reused", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	auto root   = hierarchy.create(registry.create());
+	auto middle = hierarchy.create(registry.create());
+	auto leaf   = hierarchy.create(registry.create());
+	hierarchy.set_parent(middle, root);
+	hierarchy.set_parent(leaf, middle);
+	hierarchy.update();
+
+	auto middle_entity = hierarchy.entity_at(1);
+	hierarchy.destroy(middle);
+
+	REQUIRE(hierarchy.size() == 2);
+	REQUIRE(hierarchy.get_parent(leaf) == root);
+	REQUIRE_FALSE(registry.all_of<remus::Transform>(middle_entity));
+
+	auto reused = hierarchy.create(registry.create());
+	REQUIRE(reused == middle);
+	REQUIRE(hierarchy.get_parent(reused) == remus::Hierarchy::npos);
+
+	hierarchy.update();
+	REQUIRE(hierarchy.world(leaf) == hierarchy.world(root) * hierarchy.local(leaf).get_matrix());
+}
+
+TEST_CASE("Destroying random subtrees matches a recursive evaluation", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	std::mt19937                          rng(3);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	std::vector<remus::Transform> locals(512);
+	std::vector<bool>             alive(locals.size(), true);
+	for (size_t i = 0; i < locals.size(); ++i)
+	{
+		auto id = hierarchy.create(registry.create());
+
+		locals[i].translation = glm::vec3(distribution(rng), distribution(rng), distribution(rng));
+		hierarchy.local(id)   = locals[i];
+
+		if (i > 0)
+		{
+			hierarchy.set_parent(id, static_cast<remus::Hierarchy::Id>(rng() % i));
+		}
+	}
+
+	hierarchy.update();
+
+	std::vector<entt::entity> destroyed;
+	for (int i = 0; i < 8; ++i)
+	{
+		auto id = static_cast<remus::Hierarchy::Id>(rng() % locals.size());
+		if (!alive[id])
+		{
+			continue;
+		}
+
+		// every live descendant of id goes with it
+		for (remus::Hierarchy::Id other = 0; other < locals.size(); ++other)
+		{
+			for (auto ancestor = other; alive[other] && ancestor != remus::Hierarchy::npos; ancestor = hierarchy.get_parent(ancestor))
+			{
+				if (ancestor == id)
+				{
+					alive[other] = false;
+				}
+			}
+		}
+
+		hierarchy.destroy_subtree(id, destroyed);
+
+		// the remaining nodes are still recomputed correctly after moving one of them
+		auto moved = static_cast<remus::Hierarchy::Id>(rng() % locals.size());
+		if (alive[moved])
+		{
+			locals[moved].translation.x += 1.0f;
+			hierarchy.local(moved) = locals[moved];
+			hierarchy.mark_dirty(moved);
+		}
+		hierarchy.update();
+	}
+
+	REQUIRE(hierarchy.size() == static_cast<size_t>(std::count(alive.begin(), alive.end(), true)));
+	REQUIRE(destroyed.size() == locals.size() - hierarchy.size());
+
+	for (auto entity : destroyed)
+	{
+		REQUIRE_FALSE(registry.all_of<remus::WorldMatrix>(entity));
+	}
+
+	for (remus::Hierarchy::Id id = 0; id < locals.size(); ++id)
+	{
+		if (alive[id])
+		{
+			REQUIRE(hierarchy.world(id) == expected_world(hierarchy, locals, id));
+		}
+	}
+}
+
+TEST_CASE("Parents are stored before their children after an update", "[scene_graph]")
+{
+	entt::registry   registry;
+	remus::Hierarchy hierarchy(registry);
+
+	std::vector<remus::Hierarchy::Id> ids;
+	for (int i = 0; i < 64; ++i)
+	{
+		ids.push_back(hierarchy.create(registry.create()));
+	}
+
+	// every node is parented to one created after it, the worst case for the sorted order
+	for (size_t i = 0; i + 1 < ids.size(); ++i)
+	{
+		hierarchy.set_parent(ids[i], ids[i + 1]);
+	}
+
+	auto root = hierarchy.create(registry.create());
+	hierarchy.set_parent(ids.data(), 1, root);
+	REQUIRE_THROWS(hierarchy.set_parent(&root, 1, ids.front()));
+
+	hierarchy.update();
+
+	for (uint32_t position = 0; position < hierarchy.size(); ++position)
+	{
+		auto parent = hierarchy.parent_at(position);
+		REQUIRE((parent == remus::Hierarchy::npos || parent < position));
+	}
+	REQUIRE(hierarchy.get_parent(ids.front()) == root);
+}
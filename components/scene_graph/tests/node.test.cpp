@@ -1,5 +1,7 @@
 #include <scene_graph/scene_graph.hpp>
 
+#include <algorithm>
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Create a Node", "[scene_graph]")
@@ -50,3 +52,201 @@ TEST_CASE("Remove a component", "[scene_graph]")
 
 	REQUIRE(!node.has_component<Data>());
 }
+
+TEST_CASE("World matrices follow the parent", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto parent = scene_graph.create_node();
+	auto child  = scene_graph.create_node();
+	child.set_parent(parent);
+
+	parent.transform().rotation    = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	parent.transform().translation = glm::vec3(1.0f, 0.0f, 0.0f);
+	child.transform().rotation     = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	child.transform().translation  = glm::vec3(0.0f, 2.0f, 0.0f);
+
+	scene_graph.update(0.0f);
+
+	REQUIRE(child.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, 2.0f, 0.0f, 1.0f));
+
+	// moving the parent alone updates the child
+	parent.transform().translation = glm::vec3(3.0f, 0.0f, 0.0f);
+
+	scene_graph.update(0.0f);
+
+	REQUIRE(parent.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(3.0f, 0.0f, 0.0f, 1.0f));
+	REQUIRE(child.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(3.0f, 2.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE("Static nodes are not updated", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto node = scene_graph.create_node();
+
+	scene_graph.update(0.0f);
+
+	// write a sentinel which would be overwritten if the node was recomputed
+	node.get_component<remus::WorldMatrix>().matrix = glm::mat4(2.0f);
+
+	scene_graph.update(0.0f);
+	REQUIRE(node.get_component<remus::WorldMatrix>().matrix == glm::mat4(2.0f));
+
+	node.transform();
+
+	scene_graph.update(0.0f);
+	REQUIRE(node.get_component<remus::WorldMatrix>().matrix != glm::mat4(2.0f));
+}
+
+TEST_CASE("Destroyed nodes invalidate their handles", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto node = scene_graph.create_node();
+	node.set_name("destroyed");
+	node.add_component<Data>();
+
+	auto copy = node;
+	scene_graph.destroy_node(node);
+
+	REQUIRE_FALSE(node.is_valid());
+	REQUIRE_FALSE(copy.is_valid());
+	REQUIRE_THROWS(node.get_component<Data>());
+	REQUIRE_THROWS(scene_graph.destroy_node(node));
+
+	// the slot is recycled, the old handle still refers to the destroyed node
+	auto recycled = scene_graph.create_node();
+
+	REQUIRE(recycled.is_valid());
+	REQUIRE(entt::to_entity(recycled.get_entity()) == entt::to_entity(node.get_entity()));
+	REQUIRE(recycled != node);
+	REQUIRE_FALSE(node.is_valid());
+	REQUIRE(recycled.get_name().empty());
+	REQUIRE_FALSE(recycled.has_component<Data>());
+}
+
+TEST_CASE("Destroying a node moves its children to its parent", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto root   = scene_graph.create_node();
+	auto middle = scene_graph.create_node();
+	auto leaf   = scene_graph.create_node();
+	middle.set_parent(root);
+	leaf.set_parent(middle);
+
+	for (auto *node : {&root, &middle, &leaf})
+	{
+		node->transform().rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	root.transform().translation   = glm::vec3(1.0f, 0.0f, 0.0f);
+	middle.transform().translation = glm::vec3(0.0f, 2.0f, 0.0f);
+	leaf.transform().translation   = glm::vec3(0.0f, 0.0f, 3.0f);
+
+	scene_graph.update(0.0f);
+	REQUIRE(leaf.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, 2.0f, 3.0f, 1.0f));
+
+	scene_graph.destroy_node(middle);
+	scene_graph.update(0.0f);
+
+	REQUIRE(leaf.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, 0.0f, 3.0f, 1.0f));
+}
+
+TEST_CASE("Destroy a subtree", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto root    = scene_graph.create_node();
+	auto branch  = scene_graph.create_node();
+	auto leaf    = scene_graph.create_node();
+	auto sibling = scene_graph.create_node();
+	branch.set_parent(root);
+	leaf.set_parent(branch);
+	sibling.set_parent(root);
+
+	scene_graph.update(0.0f);
+	scene_graph.destroy_subtree(branch);
+
+	REQUIRE(root.is_valid());
+	REQUIRE(sibling.is_valid());
+	REQUIRE_FALSE(branch.is_valid());
+	REQUIRE_FALSE(leaf.is_valid());
+
+	root.transform().rotation    = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	root.transform().translation = glm::vec3(1.0f, 0.0f, 0.0f);
+	sibling.transform().rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+	scene_graph.update(0.0f);
+	REQUIRE(sibling.get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE("Streaming subtrees in and out reuses their slots", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	auto world = scene_graph.create_node();
+
+	uint32_t highest_index = 0;
+	for (int level = 0; level < 16; ++level)
+	{
+		auto level_root = scene_graph.create_node();
+		level_root.set_parent(world);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			auto node = scene_graph.create_node();
+			node.set_parent(level_root);
+			node.add_component<Data>();
+			highest_index = std::max(highest_index, entt::to_entity(node.get_entity()));
+		}
+
+		scene_graph.update(0.0f);
+		scene_graph.destroy_subtree(level_root);
+	}
+
+	// one level plus the world node is alive at any time
+	REQUIRE(highest_index <= 101);
+	REQUIRE(world.is_valid());
+
+	size_t remaining = 0;
+	for (auto entity : scene_graph.registry().view<Data>())
+	{
+		remaining++;
+	}
+	REQUIRE(remaining == 0);
+}
+
+TEST_CASE("Reparent many nodes at once", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+
+	std::vector<remus::SceneNodeRef> children;
+	for (int i = 0; i < 100; ++i)
+	{
+		auto child                    = scene_graph.create_node();
+		child.transform().rotation    = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		child.transform().translation = glm::vec3(0.0f, static_cast<float>(i), 0.0f);
+		children.push_back(child);
+	}
+
+	auto parent                    = scene_graph.create_node();
+	parent.transform().rotation    = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	parent.transform().translation = glm::vec3(1.0f, 0.0f, 0.0f);
+
+	scene_graph.set_parent(children.data(), children.size(), parent);
+	scene_graph.update(0.0f);
+
+	for (int i = 0; i < 100; ++i)
+	{
+		REQUIRE(children[i].get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, static_cast<float>(i), 0.0f, 1.0f));
+	}
+
+	// an expired handle is rejected before anything is moved
+	auto other = scene_graph.create_node();
+	scene_graph.destroy_node(children.back());
+	REQUIRE_THROWS(scene_graph.set_parent(children.data(), children.size(), other));
+	scene_graph.update(0.0f);
+	REQUIRE(children.front().get_component<remus::WorldMatrix>().matrix[3] == glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+}
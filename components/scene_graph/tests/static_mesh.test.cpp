@@ -0,0 +1,48 @@
+#include <scene_graph/components/static_mesh.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("View packed bytes", "[scene_graph]")
+{
+	auto view = remus::AccessorView::from_bytes({0, 1, 2, 3, 4, 5}, 2);
+	REQUIRE(view.count == 3);
+	REQUIRE(view.size() == 6);
+	REQUIRE(view.is_packed());
+	REQUIRE(*view.element(2) == 4);
+
+	// copies of a view share its bytes
+	auto copy = view;
+	REQUIRE(copy.data.get() == view.data.get());
+	REQUIRE(view.copy() == std::vector<uint8_t>{0, 1, 2, 3, 4, 5});
+
+	remus::AccessorView empty;
+	REQUIRE(empty.empty());
+	REQUIRE(empty.copy().empty());
+}
+
+TEST_CASE("View interleaved bytes", "[scene_graph]")
+{
+	// two elements of two bytes, each followed by two bytes of another attribute
+	auto buffer = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{1, 2, 9, 9, 3, 4, 9, 9});
+
+	remus::AccessorView view;
+	view.data         = std::shared_ptr<const uint8_t>(buffer, buffer->data());
+	view.count        = 2;
+	view.element_size = 2;
+	view.stride       = 4;
+
+	REQUIRE(view.is_packed() == false);
+	REQUIRE(view.size() == 4);
+	REQUIRE(*view.element(1) == 3);
+	REQUIRE(view.copy() == std::vector<uint8_t>{1, 2, 3, 4});
+
+	// the view keeps the buffer alive
+	std::weak_ptr<const std::vector<uint8_t>> weak = buffer;
+	buffer.reset();
+	REQUIRE(weak.expired() == false);
+	view = {};
+	REQUIRE(weak.expired());
+}
@@ -120,3 +120,199 @@ TEST_CASE("Update a system with arguments", "[scene_graph]")
 		REQUIRE(node.get_component<SystemData>().i == (i + 1) * increment_amount);
 	}
 }
+
+struct Position
+{
+	float value = 0.0f;
+};
+
+struct Velocity
+{
+	float value = 1.0f;
+};
+
+class MoveSystem final : public remus::System
+{
+  public:
+	virtual void update(entt::registry &registry, float delta_time) const override
+	{
+		auto view = registry.view<Position, Velocity>();
+		for (auto entity : view)
+		{
+			view.get<Position>(entity).value += view.get<Velocity>(entity).value * delta_time;
+		}
+	}
+
+	virtual remus::SystemAccess access() const override
+	{
+		return remus::SystemAccess{}.read<Velocity>().write<Position>();
+	}
+};
+
+class AccelerateSystem final : public remus::System
+{
+  public:
+	virtual void update(entt::registry &registry, float delta_time) const override
+	{
+		auto view = registry.view<Velocity>();
+		for (auto entity : view)
+		{
+			view.get<Velocity>(entity).value += delta_time;
+		}
+	}
+
+	virtual remus::SystemAccess access() const override
+	{
+		return remus::SystemAccess{}.write<Velocity>();
+	}
+};
+
+class CountSystem final : public remus::System
+{
+  public:
+	virtual void update(entt::registry &registry, float delta_time) const override
+	{
+		auto view = registry.view<SystemData>();
+		for (auto entity : view)
+		{
+			view.get<SystemData>(entity).i++;
+		}
+	}
+
+	virtual remus::SystemAccess access() const override
+	{
+		return remus::SystemAccess{}.write<SystemData>();
+	}
+};
+
+TEST_CASE("Declared accesses conflict", "[scene_graph]")
+{
+	auto reads_velocity  = remus::SystemAccess{}.read<Velocity>();
+	auto writes_velocity = remus::SystemAccess{}.write<Velocity>();
+	auto writes_position = remus::SystemAccess{}.write<Position>();
+
+	REQUIRE_FALSE(reads_velocity.conflicts_with(reads_velocity));
+	REQUIRE(reads_velocity.conflicts_with(writes_velocity));
+	REQUIRE(writes_velocity.conflicts_with(reads_velocity));
+	REQUIRE_FALSE(writes_velocity.conflicts_with(writes_position));
+	REQUIRE(remus::SystemAccess::exclusive().conflicts_with(writes_position));
+}
+
+class MoveTransformSystem final : public remus::System
+{
+  public:
+	virtual void update(entt::registry &registry, float delta_time) const override
+	{
+		for (auto entity : registry.view<remus::Transform>())
+		{
+			if (registry.all_of<remus::BoundingBox>(entity))
+			{
+				continue;
+			}
+			registry.patch<remus::Transform>(entity, [](remus::Transform &transform) { transform.translation.x += 1.0f; });
+		}
+	}
+
+	virtual remus::SystemAccess access() const override
+	{
+		return remus::SystemAccess{}.write<remus::Transform>();
+	}
+};
+
+class GrowBoundsSystem final : public remus::System
+{
+  public:
+	virtual void update(entt::registry &registry, float delta_time) const override
+	{
+		for (auto entity : registry.view<remus::BoundingBox>())
+		{
+			registry.patch<remus::BoundingBox>(entity, [](remus::BoundingBox &box) { box.max.x += 1.0f; });
+		}
+	}
+
+	virtual remus::SystemAccess access() const override
+	{
+		return remus::SystemAccess{}.write<remus::BoundingBox>();
+	}
+};
+
+TEST_CASE("Writes marking the hierarchy dirty conflict", "[scene_graph]")
+{
+	auto writes_transform = remus::SystemAccess{}.write<remus::Transform>();
+	auto writes_bounds    = remus::SystemAccess{}.write<remus::BoundingBox>();
+	auto reads_transform  = remus::SystemAccess{}.read<remus::Transform>();
+	auto reads_bounds     = remus::SystemAccess{}.read<remus::BoundingBox>();
+
+	REQUIRE(writes_transform.conflicts_with(writes_bounds));
+	REQUIRE(writes_bounds.conflicts_with(writes_transform));
+	REQUIRE_FALSE(reads_transform.conflicts_with(reads_bounds));
+	REQUIRE_FALSE(writes_transform.conflicts_with(reads_bounds));
+
+	// both systems mark nodes dirty every frame, no mark may be lost
+	remus::SceneGraph scene_graph;
+	scene_graph.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+
+	scene_graph.add_system<MoveTransformSystem>();
+	scene_graph.add_system<GrowBoundsSystem>();
+
+	std::vector<remus::SceneNodeRef> moved;
+	std::vector<remus::SceneNodeRef> grown;
+	for (int i = 0; i < 256; i++)
+	{
+		moved.push_back(scene_graph.create_node());
+		grown.push_back(scene_graph.create_node());
+		grown.back().add_component(remus::BoundingBox{glm::vec3(0.0f), glm::vec3(0.0f)});
+	}
+
+	constexpr int frame_count = 10;
+	for (int i = 0; i < frame_count; i++)
+	{
+		scene_graph.update(0.0f);
+	}
+
+	// the systems run after the world matrices are propagated, one more update without them picks up the last frame
+	scene_graph.remove_system<MoveTransformSystem>();
+	scene_graph.remove_system<GrowBoundsSystem>();
+	scene_graph.update(0.0f);
+
+	auto &registry = scene_graph.registry();
+	for (auto &node : moved)
+	{
+		REQUIRE(registry.get<remus::WorldMatrix>(node.get_entity()).matrix[3].x == static_cast<float>(frame_count));
+	}
+	for (auto &node : grown)
+	{
+		auto &box = registry.get<remus::WorldBoundingBox>(node.get_entity()).box;
+		REQUIRE(box.max.x - box.min.x == static_cast<float>(frame_count));
+	}
+}
+
+TEST_CASE("Update systems on a thread pool", "[scene_graph]")
+{
+	remus::SceneGraph scene_graph;
+	scene_graph.set_thread_pool(std::make_shared<remus::ThreadPool>(3));
+
+	scene_graph.add_system<MoveSystem>();
+	scene_graph.add_system<AccelerateSystem>();
+	scene_graph.add_system<CountSystem>();
+	scene_graph.add_system<IncrementSystem>();
+
+	auto node = scene_graph.create_node();
+	node.add_component<Position>();
+	node.add_component<Velocity>();
+	node.add_component<SystemData>();
+
+	for (int i = 0; i < 10; i++)
+	{
+		scene_graph.update(1.0f);
+	}
+
+	// count and increment both write the same component, they never run together
+	REQUIRE(node.get_component<SystemData>().i == 20);
+	REQUIRE(node.get_component<Position>().value > 0.0f);
+
+	auto &profile = scene_graph.system_profile();
+	REQUIRE(profile.timings.size() == 4);
+	REQUIRE_FALSE(profile.critical_path.empty());
+	REQUIRE(profile.critical_path_ms <= profile.total_ms);
+}
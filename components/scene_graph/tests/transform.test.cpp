@@ -0,0 +1,156 @@
+#include <scene_graph/transform.hpp>
+#include <scene_graph/transform_kernels.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+// the reference composition through the glm helpers
+glm::mat4 glm_matrix(const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale)
+{
+	glm::mat4 matrix(1.0f);
+	matrix = glm::translate(matrix, translation);
+	matrix *= glm::mat4_cast(rotation);
+	matrix = glm::scale(matrix, scale);
+	return matrix;
+}
+
+bool nearly_equal(const glm::mat4 &a, const glm::mat4 &b)
+{
+	for (int column = 0; column < 4; ++column)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float tolerance = 1e-5f * std::max(1.0f, std::abs(b[column][row]));
+			if (std::abs(a[column][row] - b[column][row]) > tolerance)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+struct TransformArrays
+{
+	std::vector<float> translation[3];
+	std::vector<float> rotation[4];
+	std::vector<float> scale[3];
+
+	std::vector<glm::mat4> parents;
+	std::vector<glm::mat4> expected;
+
+	remus::TransformBatch batch() const
+	{
+		return {{translation[0].data(), translation[1].data(), translation[2].data()},
+		        {rotation[0].data(), rotation[1].data(), rotation[2].data(), rotation[3].data()},
+		        {scale[0].data(), scale[1].data(), scale[2].data()}};
+	}
+};
+
+TransformArrays random_transforms(size_t count)
+{
+	std::mt19937                          rng(1234);
+	std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+	TransformArrays arrays;
+	for (size_t i = 0; i < count; ++i)
+	{
+		glm::vec3 translation(distribution(rng), distribution(rng), distribution(rng));
+		glm::quat rotation = glm::normalize(glm::quat(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+		glm::vec3 scale(0.1f + std::abs(distribution(rng)), 0.1f + std::abs(distribution(rng)), 0.1f + std::abs(distribution(rng)));
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			arrays.translation[axis].push_back(translation[axis]);
+			arrays.scale[axis].push_back(scale[axis]);
+		}
+		arrays.rotation[0].push_back(rotation.x);
+		arrays.rotation[1].push_back(rotation.y);
+		arrays.rotation[2].push_back(rotation.z);
+		arrays.rotation[3].push_back(rotation.w);
+
+		glm::quat parent_rotation = glm::normalize(glm::quat(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+		arrays.parents.push_back(glm_matrix(glm::vec3(distribution(rng)), parent_rotation, glm::vec3(2.0f)));
+
+		// every third transform is a root
+		if (i % 3 == 0)
+		{
+			arrays.expected.push_back(glm_matrix(translation, rotation, scale));
+		}
+		else
+		{
+			arrays.expected.push_back(arrays.parents.back() * glm_matrix(translation, rotation, scale));
+		}
+	}
+	return arrays;
+}
+}        // namespace
+
+TEST_CASE("Transform matrix matches the glm composition", "[scene_graph]")
+{
+	remus::Transform transform;
+	transform.translation = glm::vec3(1.0f, -2.0f, 3.0f);
+	transform.rotation    = glm::normalize(glm::quat(0.5f, 0.1f, -0.7f, 0.2f));
+	transform.scale       = glm::vec3(2.0f, 0.5f, 1.5f);
+
+	REQUIRE(nearly_equal(transform.get_matrix(), glm_matrix(transform.translation, transform.rotation, transform.scale)));
+}
+
+TEST_CASE("Transform kernels match the glm composition", "[scene_graph]")
+{
+	// not a multiple of any vector width so the scalar tail is covered as well
+	constexpr size_t count = 1003;
+
+	auto arrays = random_transforms(count);
+	auto batch  = arrays.batch();
+
+	std::vector<const glm::mat4 *> parents(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		parents[i] = i % 3 == 0 ? nullptr : &arrays.parents[i];
+	}
+
+	std::vector<glm::mat4> scalar_worlds(count);
+	{
+		std::vector<glm::mat4 *> worlds(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			worlds[i] = &scalar_worlds[i];
+		}
+		remus::compose_world_matrices(remus::TransformKernel::Scalar, batch, parents.data(), worlds.data(), count);
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		REQUIRE(nearly_equal(scalar_worlds[i], arrays.expected[i]));
+	}
+
+	for (auto kernel : {remus::TransformKernel::SSE2, remus::TransformKernel::AVX2})
+	{
+		if (!remus::is_supported(kernel))
+		{
+			continue;
+		}
+
+		std::vector<glm::mat4>   kernel_worlds(count);
+		std::vector<glm::mat4 *> worlds(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			worlds[i] = &kernel_worlds[i];
+		}
+		remus::compose_world_matrices(kernel, batch, parents.data(), worlds.data(), count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			REQUIRE(nearly_equal(kernel_worlds[i], arrays.expected[i]));
+
+			// every kernel evaluates the same operations in the same order
+			REQUIRE(std::memcmp(&kernel_worlds[i], &scalar_worlds[i], sizeof(glm::mat4)) == 0);
+		}
+	}
+}